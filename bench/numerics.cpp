@@ -0,0 +1,84 @@
+#include "headers.hpp"
+
+// send_reply and send_error against the ostringstream versions they
+// replaced, both appending to the same SendQ. Run with `make bench`.
+
+# define BENCH_LINES	1000000
+# define BENCH_BATCH	1000		// Lines queued before the SendQ is emptied
+
+static void		old_send_error( User &u, int errn, string arg )
+{
+	ostringstream s;
+
+	if (*(arg.end() - 1) == '\n')
+		arg = arg.substr(0, arg.length()-1);
+	s << ":mfirc " << errn << " * " << arg << err[errn] << "\r\n";
+
+	send_msg(u, s.str());
+}
+
+static void		old_send_reply( User &u, int rpln, string reply )
+{
+	ostringstream s;
+
+	s	<< ":mfirc "
+		<< setfill('0') << setw(3) << rpln
+		<< " " << u.getNick() << " " << reply;
+
+	send_msg(u, s.str());
+}
+
+static double	now( void )
+{
+	struct timespec	ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static double	run_reply( User &u, void (*f)( User &, int, string const & ),
+	string const &reply )
+{
+	double	start = now();
+
+	for (int i = 0; i < BENCH_LINES; i++) {
+		f(u, 366, reply);
+		if (i % BENCH_BATCH == BENCH_BATCH - 1)
+			u.getSendQ().clear();
+	}
+	return (now() - start) / BENCH_LINES;
+}
+
+static double	run_error( User &u, void (*f)( User &, int, string const & ),
+	string const &arg )
+{
+	double	start = now();
+
+	for (int i = 0; i < BENCH_LINES; i++) {
+		f(u, ERR_NOSUCHCHANNEL, arg);
+		if (i % BENCH_BATCH == BENCH_BATCH - 1)
+			u.getSendQ().clear();
+	}
+	return (now() - start) / BENCH_LINES;
+}
+
+static void		old_reply( User &u, int n, string const &s ) { old_send_reply(u, n, s); }
+static void		old_error( User &u, int n, string const &s ) { old_send_error(u, n, s); }
+
+int				main( void )
+{
+	User	u(-1);
+	string	reply = RPL_ENDOFNAMES(string("#somechannel"));
+	string	arg = "#somechannel";
+
+	define_errors();
+	u.setNick("somebody");
+	u.getSendQ().setMax((size_t)-1);
+
+	cout << "send_reply  ostringstream " << fixed << setprecision(1)
+		<< run_reply(u, old_reply, reply) << " ns/line" << endl;
+	cout << "send_reply  reserve/commit " << run_reply(u, send_reply, reply) << " ns/line" << endl;
+	cout << "send_error  ostringstream " << run_error(u, old_error, arg) << " ns/line" << endl;
+	cout << "send_error  reserve/commit " << run_error(u, send_error, arg) << " ns/line" << endl;
+	return 0;
+}
@@ -0,0 +1,46 @@
+#ifndef BANMASK_HPP
+# define BANMASK_HPP
+
+# include "headers.hpp"
+
+// ************************************************************************** //
+//                            	 BanMask Class                                //
+// ************************************************************************** //
+
+// A +b/+e/+I glob, cut once at its stars when it is set. Matching checks
+// the literal prefix, suffix and length first, which rejects most masks
+// without looking at the rest, then looks for the middle pieces left to
+// right. No backtracking and no table, whatever the mask looks like.
+// Subjects are rfc1459-folded "nick!user@host" strings.
+class BanMask
+{
+	private:
+
+		string				_mask;			// As set, for the lists
+		string				_prefix;		// Folded, before the first '*'
+		string				_suffix;		// Folded, after the last '*'
+		vector<string>		_middle;		// Folded, between two stars
+		size_t				_min_len;
+		bool				_star;
+
+	public:
+
+		/*								CONSTRUCTORS								*/
+
+		BanMask( void );
+		BanMask( string const & mask );
+		BanMask( BanMask const &src );
+		~BanMask( void );
+
+		BanMask				&operator=( BanMask const &rhs );
+
+		/*								GETTERS										*/
+
+		string const		&getMask( void ) const;
+
+		/*								MEMBERS FUNCTIONS							*/
+
+		bool				matches( string const & folded ) const;
+};
+
+#endif
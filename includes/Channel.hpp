@@ -10,6 +10,20 @@
 class Server;
 class User;
 
+// Key, topic, invitations and masks: most channels never set any, they
+// only get this block the first time one is.
+struct ChannelInfo
+{
+	string							key;
+	string							topic;
+	double							topic_when;
+	string							topic_who;		// nick!user@host of the setter
+	vector< PoolRef<User> >			invited;		// Dead once the user is released
+	vector<BanMask>					bans;			// +b
+	vector<BanMask>					excepts;		// +e, overrides +b
+	vector<BanMask>					invexs;			// +I, overrides +i
+};
+
 class Channel {
 
 	private:
@@ -17,21 +31,18 @@ class Channel {
 		/*								MEMBERS VARIABLES							*/
 
 		string							_name;
-        string							_key;
-        bool							_has_key;
-        string							_topic;
-        bool							_has_topic;
-        vector<User*>					_members;
-		vector<User*>					_invited_usrs;
-		vector<User*>					_moderators;
-		map< string,vector<string> >	_banned;
-		vector<string>					_banned_mask;
-		vector<User*>					_oper;
-		string							_mode;
+		unsigned long					_id;			// Stable for the channel's lifetime
+		size_t						_slot;			// Position in the server's directory
+		Membership *					_members;		// In join order
+		Membership *					_members_tail;
+		size_t						_nb_members;
+		ModeSet							_modes;
 		size_t							_limit;
+		unsigned						_ban_gen;		// Bumped when the bans or excepts change
+		bool							_has_key;
+		bool							_has_topic;
 		double							_creation_date;
-		double							_topic_when;
-		User *							_topic_who;
+		ChannelInfo *					_info;			// NULL until first needed
 
 		/*								CONSTRUCTORS								*/
 
@@ -39,6 +50,9 @@ class Channel {
 
 		/*								MEMBERS FUNCTIONS							*/
 
+		ChannelInfo				&info( void );
+		void					setMemberFlag( User * usr, unsigned flag, bool on );
+		bool					matchBans( User const & usr ) const;
 
 	public:
 
@@ -54,19 +68,23 @@ class Channel {
 		/*								GETTERS										*/
 
 		string const 			&getName( void ) const;
+		unsigned long			getId( void ) const;
+		size_t					getSlot( void ) const;
 		string const 			&getKey( void ) const;
 		bool const 				&getHasKey( void ) const;
 		size_t		 	 		getNbMembers( void ) const;
 		string const 			&getTopic( void ) const;
 		bool const 				&getHasTopic( void ) const;
-		vector<User*> const 	&getMembers( void ) const;
-		vector<User*> const		&getOper( void ) const;
+		Membership				*getMembers( void ) const;
 		string const			&getMode( void ) const;
+		ModeSet const			&getModes( void ) const;
 		size_t					getLimit( void ) const;
 		string const			getCreationDate( void ) const;
 		string const			getTopicWhen( void ) const;
-		User *					getTopicWho( void ) const;
-		vector<string> const	&getBanMask( void ) const;
+		string const			&getTopicWho( void ) const;
+		vector<BanMask> const	&getBanMask( void ) const;
+		vector<BanMask> const	&getExceptMask( void ) const;
+		vector<BanMask> const	&getInvexMask( void ) const;
 
 		/*								SETTERS										*/
 
@@ -76,13 +94,20 @@ class Channel {
         void    				unsetTopic(User * u);
 		void    				unsetKey();
 		void					setMode( string mode );
+		void					setModes( ModeSet const & modes );
 		void					setLimit( int limit );
+		void					setId( unsigned long id );
+		void					setSlot( size_t slot );
 
 		/*								MEMBERS FUNCTIONS							*/
 
 		void					ban( string mask );
 		void					unban( string mask );
-		void					addMember( User * usr );
+		void					addExcept( string mask );
+		void					deleteExcept( string mask );
+		void					addInvex( string mask );
+		void					deleteInvex( string mask );
+		Membership				*addMember( User * usr, unsigned flags = 0 );
 		void					deleteMember( User * usr );
 		void					addModerator( User * usr );
 		void					deleteModerator( User * usr );
@@ -91,11 +116,11 @@ class Channel {
 		bool					isBanned( User const & usr );
 		void					invite( User * usr );
 		bool					isInvited( User const & usr );
-		bool					isInviteOnly( void );
-		bool					isPrivate( void );
-		bool					isSecret( void );
-		bool					isModerated( void );
-		bool					isTopicSettableByOperOnly( void );
+		bool					isInviteOnly( void ) const;
+		bool					isPrivate( void ) const;
+		bool					isSecret( void ) const;
+		bool					isModerated( void ) const;
+		bool					isTopicSettableByOperOnly( void ) const;
 		string					getMembersList( void );
 		bool					isOnChann( User const & usr );
 		bool					isOper( User const & usr );
@@ -0,0 +1,66 @@
+#ifndef CONNTABLE_HPP
+# define CONNTABLE_HPP
+
+# include "headers.hpp"
+
+// ************************************************************************** //
+//                            	ConnTable Class                               //
+// ************************************************************************** //
+
+class User;
+
+// Per connection state of a shard, in a slot indexed by fd
+struct Conn
+{
+	User *				user;			// NULL when the slot is free
+	LineBuf *			in;
+	int					events;			// Interest currently set in the poller
+	bool				queued;			// Already has an input this round
+	unsigned			gen;			// Bumped whenever the slot opens or closes
+};
+
+// Handle on a connection that survives its fd being closed and reused:
+// resolves to NULL once the slot's generation moved on.
+struct ConnRef
+{
+	int					fd;
+	unsigned			gen;
+};
+
+// Slab of the connections a shard owns. Only the owner opens and closes
+// slots, always under the server lock; it may read its own slots without
+// the lock, other shards only with it.
+class ConnTable
+{
+	private:
+
+		vector<Conn>		_slots;
+		size_t				_size;
+		Pool<LineBuf>		_rings;
+		Pool<IoChunk>		_chunks;		// Borrowed by the rings holding data
+
+		ConnTable( ConnTable const &src );
+		ConnTable			&operator=( ConnTable const &rhs );
+
+	public:
+
+		/*								CONSTRUCTORS								*/
+
+		ConnTable( void );
+		~ConnTable( void );
+
+		/*								GETTERS										*/
+
+		size_t				size( void ) const;
+		Pool<IoChunk> const	&getChunks( void ) const;
+		Conn *				get( int fd );
+		Conn *				get( ConnRef const & ref );
+		ConnRef				ref( int fd ) const;
+
+		/*								MEMBERS FUNCTIONS							*/
+
+		ConnRef				open( int fd, User * u );
+		void				close( int fd );
+};
+
+#endif
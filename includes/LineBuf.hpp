@@ -0,0 +1,52 @@
+#ifndef LINEBUF_HPP
+# define LINEBUF_HPP
+
+# include "headers.hpp"
+
+// ************************************************************************** //
+//                            	LineBuf Class                                 //
+// ************************************************************************** //
+
+// Inbound bytes of one connection, framed into lines. Data is read straight
+// into a fixed ring and only the bytes that arrived since the last call are
+// scanned for CR/LF. Lines are handed out as views, cut at MSG_MAXLEN like
+// RFC 1459 says; a line wrapping around the end of the ring is the only one
+// copied, into _line. The ring is a chunk borrowed from the shard's pool
+// while it holds data, idle connections keep none.
+class LineBuf
+{
+	private:
+
+		Pool<IoChunk> &		_chunks;
+		char *				_buf;			// NULL while empty
+		char				_line[MSG_MAXLEN];
+		size_t				_head;			// Start of the first unread line
+		size_t				_tail;			// End of the received data
+		size_t				_scan;			// Bytes before it hold no CR/LF
+		bool				_discard;		// Skipping the rest of a line too long
+
+		LineBuf( LineBuf const &src );
+		LineBuf				&operator=( LineBuf const &rhs );
+
+		char const *		view( size_t start, size_t len );
+		void				giveBack( void );
+
+	public:
+
+		/*								CONSTRUCTORS								*/
+
+		LineBuf( Pool<IoChunk> & chunks );
+		~LineBuf( void );
+
+		/*								GETTERS										*/
+
+		size_t				size( void ) const;
+
+		/*								MEMBERS FUNCTIONS							*/
+
+		char *				room( size_t & len );
+		void				filled( size_t n );
+		bool				next( char const * & line, size_t & len );
+};
+
+#endif
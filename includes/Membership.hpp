@@ -0,0 +1,35 @@
+#ifndef MEMBERSHIP_HPP
+# define MEMBERSHIP_HPP
+
+# include "headers.hpp"
+
+# define MEMBER_OP			0x01		// +o
+# define MEMBER_VOICE		0x02		// +v, may speak on a moderated channel
+
+// ************************************************************************** //
+//                            	Membership Struct                             //
+// ************************************************************************** //
+
+class User;
+class Channel;
+
+// One user on one channel. The node is linked in two lists at once, the
+// channel's members and the user's channels, so leaving unlinks it from
+// both in constant time. A user is on MAX_CHAN_PER_USR channels at most:
+// walking its own list is how "is X on #chan" gets answered, whatever
+// the size of the channel.
+struct Membership
+{
+	User *				user;
+	Channel *			chan;
+	unsigned			flags;			// MEMBER_*
+	bool				banned;			// Cached Channel::isBanned() verdict,
+	unsigned			ban_gen;		// valid while both generations match
+	unsigned			ident_gen;
+	Membership *		chan_prev;
+	Membership *		chan_next;
+	Membership *		user_prev;
+	Membership *		user_next;
+};
+
+#endif
@@ -0,0 +1,65 @@
+#ifndef MESSAGE_HPP
+# define MESSAGE_HPP
+
+# include "headers.hpp"
+
+// ************************************************************************** //
+//                            	Message Class                                 //
+// ************************************************************************** //
+
+// Bytes owned by someone else: a token of the line being parsed
+struct StrView
+{
+	char const *		ptr;
+	size_t				len;
+
+	StrView( void );
+	StrView( char const * p, size_t n );
+
+	size_t				size( void ) const;
+	bool				empty( void ) const;
+	char				operator[]( size_t i ) const;	// '\0' past the end, like string
+	string				str( void ) const;
+
+	bool				operator==( char const * s ) const;
+	bool				operator==( string const & s ) const;
+	bool				operator!=( char const * s ) const;
+	bool				operator!=( string const & s ) const;
+};
+
+// One parsed line: [@tags] [:prefix] <command> {<middle>} [:<trailing>].
+// Every part is a view into the line, nothing is copied; the message is only
+// valid while the line is, i.e. during the command handler.
+class Message
+{
+	private:
+
+		StrView				_tags;
+		StrView				_prefix;
+		StrView				_command;
+		StrView				_params[MSG_MAXPARAMS];
+		size_t				_nparams;
+		bool				_trailing;		// Last param came after a ':'
+
+	public:
+
+		/*								CONSTRUCTORS								*/
+
+		Message( void );
+
+		/*								GETTERS										*/
+
+		StrView const &		getTags( void ) const;
+		StrView const &		getPrefix( void ) const;
+		StrView const &		getCommand( void ) const;
+		size_t				size( void ) const;
+		StrView const &		operator[]( size_t i ) const;
+		bool				hasTrailing( void ) const;
+
+		/*								MEMBERS FUNCTIONS							*/
+
+		bool				parse( char const * line, size_t len );
+		string				join( size_t from ) const;
+};
+
+#endif
@@ -0,0 +1,60 @@
+#ifndef MODESET_HPP
+# define MODESET_HPP
+
+# include "headers.hpp"
+
+// ************************************************************************** //
+//                            	 ModeSet Class                                //
+// ************************************************************************** //
+
+// User or channel modes, one bit per letter: checking a mode on the
+// PRIVMSG or JOIN path is a single bit test. The string shown in
+// RPL_UMODEIS/RPL_CHANNELMODEIS is kept sorted and only rebuilt when a
+// mode actually changes.
+class ModeSet
+{
+	private:
+
+		uint64_t			_bits;			// A-Z then a-z
+		string				_str;
+
+		void				update( void );
+
+	public:
+
+		/*								CONSTRUCTORS								*/
+
+		ModeSet( void );
+		ModeSet( string const & modes );
+		ModeSet( ModeSet const &src );
+		~ModeSet( void );
+
+		ModeSet				&operator=( ModeSet const &rhs );
+
+		/*								GETTERS										*/
+
+		string const		&str( void ) const;
+		bool				has( char c ) const;
+
+		/*								MEMBERS FUNCTIONS							*/
+
+		bool				add( char c );
+		bool				remove( char c );
+};
+
+// Bit of a mode letter, 0 for anything else
+inline uint64_t		mode_bit( char c )
+{
+	if (c >= 'A' && c <= 'Z')
+		return (uint64_t)1 << (c - 'A');
+	if (c >= 'a' && c <= 'z')
+		return (uint64_t)1 << (c - 'a' + 26);
+	return 0;
+}
+
+inline bool			ModeSet::has( char c ) const
+{
+	return (_bits & mode_bit(c)) != 0;
+}
+
+#endif
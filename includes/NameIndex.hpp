@@ -0,0 +1,151 @@
+#ifndef NAMEINDEX_HPP
+# define NAMEINDEX_HPP
+
+# include "headers.hpp"
+
+// rfc1459 casemapping
+string				irc_fold( string const & s );
+bool				irc_equals( string const & a, string const & b );
+size_t				irc_hash( string const & s );
+
+// ************************************************************************** //
+//                            	NameIndex Class                               //
+// ************************************************************************** //
+
+// Hash index from a nick or channel name to its object, compared with the
+// rfc1459 casemapping: "Nick[1]" and "nick{1}" are the same key. Open
+// addressing with linear probing, entries are shifted back on erase so no
+// tombstones pile up under churn. Lookups fold and hash on the fly,
+// without building the folded string.
+template<typename T>
+class NameIndex
+{
+	private:
+
+		struct Slot
+		{
+			T *				val;			// NULL when free
+			size_t			hash;
+			string			key;			// Folded
+
+			Slot( void ) : val(NULL), hash(0), key() {}
+		};
+
+		vector<Slot>		_slots;
+		size_t				_size;
+
+		size_t				lookup( string const & name, size_t h ) const;
+		void				grow( void );
+
+	public:
+
+		/*								CONSTRUCTORS								*/
+
+		NameIndex( void );
+
+		/*								GETTERS										*/
+
+		size_t				size( void ) const;
+		T *					find( string const & name ) const;
+
+		/*								MEMBERS FUNCTIONS							*/
+
+		bool				insert( string const & name, T * val );
+		void				erase( string const & name );
+};
+
+template<typename T>
+NameIndex<T>::NameIndex( void ) : _slots(16), _size(0)
+{
+}
+
+template<typename T>
+size_t				NameIndex<T>::size( void ) const
+{
+	return _size;
+}
+
+// Slot holding name, or the free slot where it would go
+template<typename T>
+size_t				NameIndex<T>::lookup( string const & name, size_t h ) const
+{
+	size_t		mask = _slots.size() - 1;
+	size_t		i = h & mask;
+
+	while (_slots[i].val) {
+		if (_slots[i].hash == h && irc_equals(_slots[i].key, name))
+			return i;
+		i = (i + 1) & mask;
+	}
+	return i;
+}
+
+template<typename T>
+T *					NameIndex<T>::find( string const & name ) const
+{
+	return _slots[lookup(name, irc_hash(name))].val;
+}
+
+template<typename T>
+bool				NameIndex<T>::insert( string const & name, T * val )
+{
+	size_t		h = irc_hash(name);
+	size_t		i = lookup(name, h);
+
+	if (_slots[i].val)
+		return false;
+	_slots[i].val = val;
+	_slots[i].hash = h;
+	_slots[i].key = irc_fold(name);
+	// Keep probes short: at most half full
+	if (++_size * 2 > _slots.size())
+		grow();
+	return true;
+}
+
+template<typename T>
+void				NameIndex<T>::erase( string const & name )
+{
+	size_t		mask = _slots.size() - 1;
+	size_t		i = lookup(name, irc_hash(name));
+
+	if (!_slots[i].val)
+		return ;
+	_slots[i].val = NULL;
+	_size--;
+
+	// Move back the entries that probed past the hole
+	for (size_t j = (i + 1) & mask; _slots[j].val; j = (j + 1) & mask) {
+		size_t	home = _slots[j].hash & mask;
+
+		if (((j - home) & mask) < ((j - i) & mask))
+			continue ;
+		_slots[i].val = _slots[j].val;
+		_slots[i].hash = _slots[j].hash;
+		_slots[i].key.swap(_slots[j].key);
+		_slots[j].val = NULL;
+		i = j;
+	}
+}
+
+template<typename T>
+void				NameIndex<T>::grow( void )
+{
+	vector<Slot>	old(_slots.size() * 2);
+
+	old.swap(_slots);
+	for (size_t i = 0; i < old.size(); i++) {
+		if (!old[i].val)
+			continue ;
+
+		size_t		j = old[i].hash & (_slots.size() - 1);
+
+		while (_slots[j].val)
+			j = (j + 1) & (_slots.size() - 1);
+		_slots[j].val = old[i].val;
+		_slots[j].hash = old[i].hash;
+		_slots[j].key.swap(old[i].key);
+	}
+}
+
+#endif
@@ -0,0 +1,174 @@
+#ifndef POLLER_HPP
+# define POLLER_HPP
+
+# include "headers.hpp"
+
+// ************************************************************************** //
+//                            	Poller Classes                                //
+// ************************************************************************** //
+
+# define POLLER_IN		0x1
+# define POLLER_OUT		0x2
+# define POLLER_ERR		0x4
+# define POLLER_ACCEPT	0x8			// fd is a connection the backend accepted
+
+struct PollerEvent
+{
+	int		fd;
+	int		events;
+};
+
+// Readiness backend used by Server::run(). wait() only reports the fds that
+// are ready, so the caller never walks the whole connection table.
+//
+// Reads and writes of a round go through queueRecv()/queueSend() and
+// submit(). The readiness backends make the syscall on the spot, a
+// completion backend hands the whole batch to the kernel in submit().
+// Results are bytes or -errno, set by submit() at the latest; buffers must
+// stay untouched until then.
+class Poller {
+
+	public:
+
+		virtual ~Poller( void ) {}
+
+		virtual char const *	getName( void ) const = 0;
+		virtual bool			isEdgeTriggered( void ) const = 0;
+		virtual void			add( int fd, int events ) = 0;
+		virtual void			modify( int fd, int events ) = 0;
+		virtual void			remove( int fd ) = 0;
+		virtual int				wait( vector<PollerEvent> & ready, int timeout ) = 0;
+
+		virtual void			addListener( int fd );
+		virtual void			queueRecv( int fd, char * buf, size_t len, ssize_t * res );
+		virtual void			queueSend( int fd, struct msghdr * msg, int flags, ssize_t * res );
+		virtual void			submit( void );
+
+		static Poller *			create( string const & name );
+		static char const *		defaultName( void );
+};
+
+// poll(2) fallback, level-triggered. _index maps an fd to its slot in _pfds
+// so removal is a swap with the last slot instead of a search.
+class PollPoller : public Poller {
+
+	private:
+
+		vector<struct pollfd>	_pfds;
+		vector<int>				_index;
+
+		PollPoller(PollPoller const& src);
+		PollPoller & operator=(PollPoller const& src);
+
+	public:
+
+		PollPoller( void );
+		virtual ~PollPoller( void );
+
+		char const *			getName( void ) const;
+		bool					isEdgeTriggered( void ) const;
+		void					add( int fd, int events );
+		void					modify( int fd, int events );
+		void					remove( int fd );
+		int						wait( vector<PollerEvent> & ready, int timeout );
+};
+
+# ifdef __linux__
+
+// epoll(7) backend, edge-triggered: the caller must drain accept()/recv()
+// until EAGAIN on every notification.
+class EpollPoller : public Poller {
+
+	private:
+
+		int							_epfd;
+		vector<struct epoll_event>	_events;
+
+		EpollPoller(EpollPoller const& src);
+		EpollPoller & operator=(EpollPoller const& src);
+
+	public:
+
+		EpollPoller( void );
+		virtual ~EpollPoller( void );
+
+		char const *			getName( void ) const;
+		bool					isEdgeTriggered( void ) const;
+		void					add( int fd, int events );
+		void					modify( int fd, int events );
+		void					remove( int fd );
+		int						wait( vector<PollerEvent> & ready, int timeout );
+};
+
+# endif
+
+# ifdef HAS_IO_URING
+
+// io_uring(7) backend. Every fd is watched with a multishot POLL_ADD; arming,
+// disarming and waiting for completions share one io_uring_enter() per loop
+// iteration instead of one epoll_ctl()/epoll_wait() each. Completions fire
+// on wakeups, so it behaves as edge-triggered.
+//
+// It is also the I/O engine: the listener gets a multishot ACCEPT whose new
+// fds come out of wait(), and the reads and writes of a round are RECV and
+// SENDMSG requests submitted and reaped by one io_uring_enter(). Readiness
+// completions reaped meanwhile are kept for the next wait().
+class UringPoller : public Poller {
+
+	private:
+
+		int						_ring_fd;
+		void *					_ring;
+		size_t					_ring_sz;
+		struct io_uring_sqe *	_sqes;
+		size_t					_sqes_sz;
+		unsigned *				_sq_head;
+		unsigned *				_sq_tail;
+		unsigned *				_sq_array;
+		unsigned				_sq_mask;
+		unsigned				_sq_entries;
+		unsigned				_sq_pending;
+		unsigned *				_cq_head;
+		unsigned *				_cq_tail;
+		unsigned				_cq_mask;
+		struct io_uring_cqe *	_cqes;
+		vector<uint32_t>		_gen;		// Bumped on every re-arm, stale completions are dropped
+		vector<int>				_interest;	// POLLER_* mask per fd, 0 when not watched
+		vector<int>				_slot;		// Index in _ready, -1 if not there
+		vector<PollerEvent>		_ready;		// Reaped, not returned by wait() yet
+		vector<ssize_t *>		_ops;		// Results of the requests being submitted
+		size_t					_ops_left;	// Still to complete
+		int						_listener;	// -1 once multishot ACCEPT was refused
+
+		UringPoller(UringPoller const& src);
+		UringPoller & operator=(UringPoller const& src);
+
+		struct io_uring_sqe *	getSqe( void );
+		int						enter( unsigned min_complete, int timeout );
+		void					arm( int fd );
+		void					disarm( int fd );
+		void					armAccept( void );
+		void					reap( void );
+		void					readiness( int fd, int events );
+
+	public:
+
+		UringPoller( void );
+		virtual ~UringPoller( void );
+
+		char const *			getName( void ) const;
+		bool					isEdgeTriggered( void ) const;
+		void					add( int fd, int events );
+		void					modify( int fd, int events );
+		void					remove( int fd );
+		int						wait( vector<PollerEvent> & ready, int timeout );
+
+		void					addListener( int fd );
+		void					queueRecv( int fd, char * buf, size_t len, ssize_t * res );
+		void					queueSend( int fd, struct msghdr * msg, int flags, ssize_t * res );
+		void					submit( void );
+};
+
+# endif
+
+#endif
@@ -0,0 +1,201 @@
+#ifndef POOL_HPP
+# define POOL_HPP
+
+# include "headers.hpp"
+
+// ************************************************************************** //
+//                            	  Pool Class                                  //
+// ************************************************************************** //
+
+// Fixed size allocator for the objects created and destroyed all the time
+// (users, channels, memberships, input rings). Slots are carved out of
+// slabs and recycled through a free list, so connect storms and channel
+// churn don't go through malloc and live objects stay packed together.
+// Slabs are only given back when the pool dies, live objects must have
+// been released by then. Not thread safe: pools are used under the server
+// lock.
+//
+// Each slot starts with a generation bumped on release. A PoolRef keeps
+// the one its object had, so a pointer kept past the object's death is
+// told apart from the next object built in the same slot.
+template<typename T>
+struct PoolRef
+{
+	T *					ptr;
+	unsigned			gen;
+};
+
+template<typename T>
+class Pool
+{
+	private:
+
+		struct Free
+		{
+			Free *			next;
+		};
+
+		// Sized and aligned for anything that follows it
+		union Header
+		{
+			unsigned		gen;
+			long double		align;
+		};
+
+		vector<char *>		_slabs;
+		Free *				_free;
+		size_t				_size;			// Live objects
+		size_t				_peak;			// Most live objects at once
+		size_t				_per_slab;
+
+		Pool( Pool const &src );
+		Pool				&operator=( Pool const &rhs );
+
+		static size_t		slotSize( void );
+		static Header *		header( T const * p );
+		void				grow( void );
+
+	public:
+
+		/*								CONSTRUCTORS								*/
+
+		Pool( void );
+		~Pool( void );
+
+		/*								GETTERS										*/
+
+		size_t				size( void ) const;
+		size_t				peak( void ) const;
+		size_t				capacity( void ) const;
+		static PoolRef<T>	ref( T * p );
+		static T *			get( PoolRef<T> const & r );
+
+		/*								MEMBERS FUNCTIONS							*/
+
+		void *				alloc( void );
+		void				release( T * p );
+};
+
+template<typename T>
+Pool<T>::Pool( void ) : _slabs(), _free(NULL), _size(0), _peak(0),
+	_per_slab(max((size_t)POOL_SLAB_MIN, (size_t)POOL_SLAB_SIZE / slotSize()))
+{
+}
+
+template<typename T>
+Pool<T>::~Pool( void )
+{
+	for (size_t i = 0; i < _slabs.size(); i++)
+		::operator delete(_slabs[i]);
+}
+
+// A free slot holds the free list link, a live one the object, both after
+// the header. Rounded up to the header's size so every slot in a slab
+// starts as aligned as the first one.
+template<typename T>
+size_t				Pool<T>::slotSize( void )
+{
+	size_t			payload = sizeof(T) < sizeof(Free) ? sizeof(Free) : sizeof(T);
+
+	return (sizeof(Header) + payload + sizeof(Header) - 1) / sizeof(Header) * sizeof(Header);
+}
+
+template<typename T>
+typename Pool<T>::Header *	Pool<T>::header( T const * p )
+{
+	return reinterpret_cast<Header *>(
+		const_cast<char *>(reinterpret_cast<char const *>(p)) - sizeof(Header));
+}
+
+/*								GETTERS										*/
+
+template<typename T>
+size_t				Pool<T>::size( void ) const
+{
+	return _size;
+}
+
+template<typename T>
+size_t				Pool<T>::peak( void ) const
+{
+	return _peak;
+}
+
+template<typename T>
+size_t				Pool<T>::capacity( void ) const
+{
+	return _slabs.size() * _per_slab;
+}
+
+// Only for objects built in a pool's slot
+template<typename T>
+PoolRef<T>			Pool<T>::ref( T * p )
+{
+	PoolRef<T>	r;
+
+	r.ptr = p;
+	r.gen = p ? header(p)->gen : 0;
+	return r;
+}
+
+// NULL once the object has been released, even if its slot was reused
+template<typename T>
+T *					Pool<T>::get( PoolRef<T> const & r )
+{
+	if (!r.ptr || header(r.ptr)->gen != r.gen)
+		return NULL;
+	return r.ptr;
+}
+
+/*								MEMBERS FUNCTIONS							*/
+
+// Threads a new slab's slots into the free list, in address order
+template<typename T>
+void				Pool<T>::grow( void )
+{
+	char *		slab = static_cast<char *>(::operator new(_per_slab * slotSize()));
+
+	_slabs.push_back(slab);
+	for (size_t i = _per_slab; i-- > 0; ) {
+		char *	slot = slab + i * slotSize();
+		Free *	f = reinterpret_cast<Free *>(slot + sizeof(Header));
+
+		reinterpret_cast<Header *>(slot)->gen = 0;
+		f->next = _free;
+		_free = f;
+	}
+}
+
+// Raw storage for one T, to be built with placement new:
+//	T * p = new (pool.alloc()) T(...);
+template<typename T>
+void *				Pool<T>::alloc( void )
+{
+	if (!_free)
+		grow();
+
+	Free *		f = _free;
+
+	_free = f->next;
+	if (++_size > _peak)
+		_peak = _size;
+	return f;
+}
+
+// Destroys the object and recycles its slot, last freed is first reused
+template<typename T>
+void				Pool<T>::release( T * p )
+{
+	if (!p)
+		return ;
+	p->~T();
+	header(p)->gen++;
+
+	Free *		f = reinterpret_cast<Free *>(p);
+
+	f->next = _free;
+	_free = f;
+	_size--;
+}
+
+#endif
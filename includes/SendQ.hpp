@@ -0,0 +1,65 @@
+#ifndef SENDQ_HPP
+# define SENDQ_HPP
+
+# include "headers.hpp"
+
+// ************************************************************************** //
+//                            	 SendQ Class                                  //
+// ************************************************************************** //
+
+// Outbound bytes of one connection. Replies are appended while commands run
+// and written by the owning shard once they are done, all in one gathered
+// write; whatever the socket doesn't take stays here until it becomes
+// writable again. The owner can detach the queued buffers under the server
+// lock, write them without it and attach back what is left.
+class SendQ
+{
+	private:
+
+		deque<SharedBuf>	_bufs;
+		size_t				_offset;		// Already sent bytes of _bufs.front()
+		size_t				_size;
+		size_t				_max;
+		bool				_exceeded;		// Ceiling hit, the client must be dropped
+		bool				_scheduled;		// Already in its shard's flush list
+
+		static void			drop( deque<SharedBuf> & bufs, size_t & offset, size_t n );
+
+	public:
+
+		/*								CONSTRUCTORS								*/
+
+		SendQ( size_t max = SENDQ_MAX );
+		SendQ( SendQ const &src );
+		~SendQ( void );
+
+		SendQ				&operator=( SendQ const &rhs );
+
+		/*								GETTERS										*/
+
+		size_t				size( void ) const;
+		bool				empty( void ) const;
+		bool				exceeded( void ) const;
+		bool				isScheduled( void ) const;
+
+		/*								SETTERS										*/
+
+		void				setMax( size_t max );
+		void				setScheduled( bool scheduled );
+
+		/*								MEMBERS FUNCTIONS							*/
+
+		bool				push( string const & msg );
+		bool				push( SharedBuf const & msg );
+		char *				reserve( size_t n );
+		void				commit( size_t n );
+		int					flush( int fd );
+		void				clear( void );
+		void				detach( deque<SharedBuf> & bufs, size_t & offset );
+		bool				attach( deque<SharedBuf> & bufs, size_t offset, size_t sent );
+		static ssize_t		write( int fd, deque<SharedBuf> const & bufs, size_t offset );
+		static size_t		gather( deque<SharedBuf> const & bufs, size_t first, size_t offset,
+								struct msghdr & msg, struct iovec * iov, int & flags );
+};
+
+#endif
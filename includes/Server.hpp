@@ -7,6 +7,65 @@
 //                            	Server Class                                  //
 // ************************************************************************** //
 
+class Server;
+
+// One event loop thread. Each shard owns a SO_REUSEPORT listener, a poller and
+// the connections it accepted: only the owning shard reads from, writes to,
+// registers or closes them. Everything else (users, channels, commands) is
+// shared and guarded by the server lock. A command running on any shard
+// queues replies in the recipients' SendQ and hands them to their owning
+// shard through wantFlush(), which wakes that shard up if needed.
+struct Shard
+{
+	int				id;
+	int				sockfd;
+	int				wake[2];		// Self-pipe written by the other shards
+	Poller *		poller;
+	pthread_t		thread;
+	Server *		srv;
+	ConnTable		conns;			// Connections accepted by this shard
+	vector<ConnRef>	flush;			// Connections with queued output, under the server lock
+									// Their buffers are written without it
+	vector<ConnRef>	pending;		// Unread data or lines left for the next round
+	vector<ConnRef>	lagged;			// Connections out of tokens with lines left
+	TimerWheel		timers;			// Timeouts of the shard's connections, in seconds
+	uint64_t		now;			// Monotonic seconds at the last wakeup
+	size_t			backlog_max;	// Most connections carried over to one round
+	size_t			backlog_bytes;	// Input they left queued this round
+	size_t			pools_seen;		// I/O pool slots at the last report
+
+	void			wantFlush( User & u );
+};
+
+// Bytes read from one connection outside the server lock
+struct Input
+{
+	ConnRef			ref;
+	bool			gone;
+	bool			more;			// Ring filled up before the socket was drained
+	bool			reading;		// Drained, full or gone once false
+	size_t			asked;			// Room offered to the last read
+	ssize_t			res;			// Of the last read, bytes or -errno
+};
+
+// Output detached from one connection, written outside the server lock.
+// Only the owning shard closes a connection, so it stays open meanwhile.
+struct Output
+{
+	ConnRef				ref;
+	deque<SharedBuf>	bufs;
+	size_t				offset;
+	ssize_t				sent;			// -1 on a socket error
+	int					error;
+	bool				writing;		// Socket full, failed or all sent once false
+	size_t				first;			// Next buffer to gather
+	size_t				skip;			// Bytes of it already sent
+	size_t				batch;			// Bytes gathered for the last sendmsg
+	ssize_t				res;			// Of the last sendmsg, bytes or -errno
+	struct msghdr		msg;
+	struct iovec		iov[SENDQ_IOV];
+};
+
 class Server {
 
 	private:
@@ -16,17 +75,29 @@ class Server {
 		string					_name;
 		int						_status;
 		int						_sockfd;
-		int						_newfd;
-		int						_fd_count;
 		string					_port;
 		string					_pwd;
 		string					_host;
 		struct addrinfo 		_hints;
 		struct addrinfo			*_servinfo;
-		struct pollfd			_poll[MAXCLI + 1];
+		string					_poller_name;
+		size_t					_max_clients;
+		size_t					_nb_shards;
+		size_t					_sendq_max;
+		unsigned				_ping_freq;
+		unsigned				_ping_timeout;
+		unsigned				_reg_timeout;
+		unsigned				_flood_burst;
+		unsigned				_flood_rate;
+		vector<Shard*>			_shards;
+		pthread_mutex_t			_lock;
+		Pool<User>				_user_pool;
+		Pool<Channel>			_chan_pool;
 		vector<User*>			_users;
-		map<int, string>		_usr_buf;
+		NameIndex<User>			_nicks;			// Casemapped nick to user
 		vector<Channel*>		_channels;
+		NameIndex<Channel>		_chan_index;	// Casemapped name to channel
+		unsigned long			_next_chan_id;
 		map<string, string>		_irc_operators;
 		string					_motd;
 		string					_creation_date;
@@ -41,10 +112,17 @@ class Server {
 		int						setSocket( struct addrinfo * p );
 		int						bindPort( struct addrinfo * p );
 		void					listenHost( void );
-		int						sendData( int fd );
-		int						receiveData( int i );
-		void					acceptConn( void );
-		bool					add_to_pfds(int newfd);
+		void					readInputs( Shard & sh, vector<Input> & inputs );
+		void					processData( Shard & sh, Input const & in );
+		void					acceptConn( Shard & sh, vector<int> & accepted, int newfd );
+		bool					add_to_pfds( Shard & sh, int newfd );
+		size_t					detachOutput( Shard & sh, vector<Output> & out );
+		static void				writeOutput( Poller & p, vector<Output> & out, size_t n );
+		void					attachOutput( Shard & sh, vector<Output> & out, size_t n );
+		void					updateEvents( User & u );
+		void					expireTimers( Shard & sh, vector<ConnRef> & expired );
+		void					reportPools( Shard & sh );
+		static void *			shardMain( void * arg );
 
 	public:
 
@@ -70,20 +148,27 @@ class Server {
 		string const				&getCreationDate( void ) const;
 		map<string, string>	const	&getIRCOperators( void ) const;
 
+		/*								SETTERS										*/
+
+		void					setOptions( map<string, string> & opts );
+
 		/*								MEMBERS FUNCTIONS							*/
 
 		void					initConn( void );
 		void					run( void );
-		bool					is_registered( User &usr );
+		void					runShard( Shard & sh );
 		bool					username_isIRCOper( string usr_name );
 		bool					isIRCOperator( string usr_name, string pswd );
-		Channel *				getChannelByName( string channel );
+		Channel *				getChannelByName( string const & channel ) const;
 		Channel *				getChannelByKey( string key );
-		User *					getUserByNick( string nick );
+		User *					getUserByNick( string const & nick ) const;
+		void					setUserNick( User & u, string const & nick );
+		Channel *				newChannel( string const & name, string const & key, User * creator );
 		void					addChannel( Channel * channel );
 		void					deleteChannel( Channel * channel );
 		void					deleteUser( User * u );
-		void					del_from_pfds(int fd);
+		void					disconnect( User & u, string const & reason );
+		void					del_from_pfds( Shard & sh, int fd );
 
 };
 
@@ -0,0 +1,77 @@
+#ifndef SHAREDBUF_HPP
+# define SHAREDBUF_HPP
+
+# include "headers.hpp"
+
+// Fixed size blocks the I/O buffers are carved from
+struct IoChunk
+{
+	char				bytes[IO_CHUNK];
+};
+
+struct IoLine
+{
+	char				bytes[IO_LINE];
+};
+
+// Pools of the output buffers, used under the server lock
+extern Pool<IoChunk>	g_out_chunks;
+extern Pool<IoLine>		g_out_lines;
+
+// ************************************************************************** //
+//                            	SharedBuf Class                               //
+// ************************************************************************** //
+
+// Immutable, refcounted wire line. A broadcast is formatted once and every
+// recipient's SendQ holds a reference to the same bytes. References are
+// only taken and dropped under the server lock, so the count is a plain counter.
+// The bytes of a buffer out of its SendQ never change, shards write them
+// without the lock.
+// A buffer created with a capacity can be filled in place as long as nobody
+// else references it. Buffers up to a chunk come from the pools, rounded up
+// to a line or a chunk; only bigger ones go through operator new.
+class SharedBuf
+{
+	private:
+
+		struct Data
+		{
+			size_t		refs;
+			size_t		len;
+			size_t		cap;
+			char		bytes[1];
+		};
+
+		Data *				_d;
+
+		void				init( char const * p, size_t n, size_t cap );
+		void				release( void );
+
+	public:
+
+		/*								CONSTRUCTORS								*/
+
+		SharedBuf( void );
+		SharedBuf( string const & s );
+		SharedBuf( char const * p, size_t n );
+		explicit SharedBuf( size_t cap );
+		SharedBuf( SharedBuf const &src );
+		~SharedBuf( void );
+
+		SharedBuf			&operator=( SharedBuf const &rhs );
+
+		/*								GETTERS										*/
+
+		char const *		data( void ) const;
+		size_t				size( void ) const;
+		size_t				room( void ) const;
+		bool				unique( void ) const;
+		static size_t		chunkRoom( void );
+
+		/*								MEMBERS FUNCTIONS							*/
+
+		char *				tail( void );
+		void				grow( size_t n );
+};
+
+#endif
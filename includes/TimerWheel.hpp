@@ -0,0 +1,63 @@
+#ifndef TIMERWHEEL_HPP
+# define TIMERWHEEL_HPP
+
+# include "headers.hpp"
+
+# define WHEEL_BITS			6
+# define WHEEL_SLOTS		(1 << WHEEL_BITS)
+# define WHEEL_LEVELS		4				// 64^4 ticks ahead at most
+
+// ************************************************************************** //
+//                            	TimerWheel Class                              //
+// ************************************************************************** //
+
+// One pending deadline of a connection, embedded in its owner
+struct Timer
+{
+	Timer *				prev;
+	Timer *				next;
+	int					slot;			// -1 when not scheduled
+	uint64_t			expires;		// Tick
+	ConnRef				ref;
+};
+
+// Hierarchical timing wheel: level n has 64 slots of 64^n ticks each.
+// Scheduling and cancelling link or unlink a node, O(1) whatever the
+// number of timers. A timer far ahead waits in an upper level and moves
+// down when its slot comes around, firing on its exact tick.
+// Every shard has its own, only touched by the shard's thread.
+class TimerWheel
+{
+	private:
+
+		Timer *				_slots[WHEEL_LEVELS * WHEEL_SLOTS];
+		uint64_t			_now;			// Last tick processed
+		size_t				_size;
+
+		TimerWheel( TimerWheel const &src );
+		TimerWheel			&operator=( TimerWheel const &rhs );
+
+		void				place( Timer * t );
+		void				cascade( int level );
+
+	public:
+
+		/*								CONSTRUCTORS								*/
+
+		TimerWheel( void );
+		~TimerWheel( void );
+
+		/*								GETTERS										*/
+
+		size_t				size( void ) const;
+		int					timeout( uint64_t now_ms ) const;
+
+		/*								MEMBERS FUNCTIONS							*/
+
+		void				start( uint64_t now );
+		void				schedule( Timer * t, uint64_t expires );
+		void				cancel( Timer * t );
+		void				advance( uint64_t now, vector<ConnRef> & expired );
+};
+
+#endif
@@ -9,27 +9,53 @@
 // ************************************************************************** //
 
 class Channel;
+struct Shard;
+
+// Set by USER and PASS, read by WHO and the welcome burst only
+struct UserInfo
+{
+	string				username;
+	string				hostname;
+	string				servername;
+	string				realname;
+	string				passwd;
+	string				fci;			// <nick>!<user>@<host>, for mask matching
+};
 
 class User
 {
 	private:
 
+		// Hot: what relaying a line to this user touches, first
 		int					_fd;
-		string				_nick;
-		string				_username;
-		string				_hostname;
-		string				_servername;
-		string				_realname;
-		string				_mode;
-		string				_passwd;
-		time_t 				*_last_act;
-		bool				_ping_status;
+		bool				_ping_status;	// PING sent, waiting for an answer
 		bool				_isset;			// If USER command is been used
 		bool				_isIRCOper;		// If OPER command is been used
 		bool				_isAuth;
+		bool				_lagged;		// In its shard's lagged list
+		Shard				*_shard;		// Event loop owning the connection
+		SendQ				*_sendq;		// Pooled, the record keeps a handle only
+		ModeSet				_modes;
+		string				_prefix;		// ":nick!user@host ", ready to send
+		char				_nick[MAX_USR_NICK_LEN + 1];
+		Membership			*_chans;		// Max chans MAX_CHAN_PER_USR, in join order
+		Membership			*_chans_tail;
+		size_t				_nb_chans;
 		Channel				*_curr_chan;	// Last joined channel
-		vector<Channel*>	_channels;		// Max chans 10
-		
+		unsigned			_ident_gen;		// Bumped when nick, user or host change
+		int					_tokens;		// Flood control, lines are read while > 0
+		uint64_t			_refilled;		// Second of the last refill
+		Timer				*_timer;		// Registration, keepalive or ping timeout
+		time_t				_last_act;		// Last line received
+		size_t				_slot;			// Position in the server's user list
+
+		// Cold, allocated on first use
+		UserInfo			*_info;
+
+		void				init( void );
+
+		UserInfo			&info( void );
+		void				updateFci( void );
 
 	public:
 
@@ -47,25 +73,34 @@ class User
 		/*								GETTERS										*/
 
 		int	const				&getFd( void ) const;
-		string const			&getNick( void ) const;
+		Shard					*getShard( void ) const;
+		SendQ					&getSendQ( void );
+		char const				*getNick( void ) const;
 		string const			&getUsername( void ) const;
 		string const			&getHostname( void ) const;
 		string const			&getServername( void ) const;
 		string const			&getRealName( void ) const;
 		string const			&getMode( void ) const;
 		string const			&getPasswd( void ) const;
-		time_t 	*				getLastAct( void ) const;
+		time_t					getLastAct( void ) const;
+		Timer					&getTimer( void );
+		int						getTokens( void ) const;
+		bool					isLagged( void ) const;
 		bool const				&getPingStatus( void ) const;
 		bool const				&getIsSet( void ) const;
 		bool const				&getIsAuth( void ) const;
-		vector<Channel*>		getChans( void ) const;
 		bool const				&getIsIRCOper( void ) const;
 		Channel					*getCurrChan( void ) const;
-		vector<Channel*> const	&getChannels( void ) const;
+		Membership				*getChannels( void ) const;
+		size_t					getNbChannels( void ) const;
+		Membership				*getMembership( Channel const &c ) const;
+		unsigned				getIdentGen( void ) const;
+		size_t					getSlot( void ) const;
 
 		/*								SETTERS										*/
 
 		void					setFd( int fd );
+		void					setShard( Shard *shard );
 		void					setNick( string nick );
 		void 					setUsername( string username );
 		void					setHostname( string hostname );
@@ -75,10 +110,12 @@ class User
 		void					setPasswd( string passwd );
 		void					setLastAct( time_t last_act );
 		void					setPingStatus( bool ping_status );
+		void					setLagged( bool lagged );
 		void					setIsSet( bool isset );
 		void					setIsAuth( bool isauth );
 		void					setIsIRCOper( bool isIRCOper );
 		void					setCurrChan( Channel *c );
+		void					setSlot( size_t slot );
 
 		/*								MEMBERS FUNCTIONS							*/
 
@@ -87,13 +124,16 @@ class User
 		bool					isIRCOper( void ) const;
 		bool					isChanOper( void ) const;
 		bool 					isVisible( void ) const;
-		string const			fci( void ) const;
+		string const			&fci( void ) const;
+		string const			&getPrefix( void ) const;
 		string					addMode( string mode );
 		string					rmMode( string mode );
-		void					addChannel( Channel * channel );
-		void					deleteChannel( Channel * channel );
+		void					linkChannel( Membership * m );
+		void					unlinkChannel( Membership * m );
 		void					leaveAllChans( void );
 		bool					isRegisteredToChan( Channel &c );
+		void					refill( uint64_t now, unsigned rate, unsigned burst );
+		void					spend( int cost );
 };
 
 #endif
\ No newline at end of file
@@ -28,6 +28,10 @@
 # define RPL_CREATIONTIME(channel, creation_time) (channel + " :" + creation_time + "\r\n")
 # define RPL_BANLIST(channel, mask) (channel + " :" + mask + "\r\n")
 # define RPL_ENDOFBANLIST(channel) (channel + " :End of channel ban list\r\n")
+# define RPL_EXCEPTLIST(channel, mask) (channel + " :" + mask + "\r\n")
+# define RPL_ENDOFEXCEPTLIST(channel) (channel + " :End of channel exception list\r\n")
+# define RPL_INVITELIST(channel, mask) (channel + " :" + mask + "\r\n")
+# define RPL_ENDOFINVITELIST(channel) (channel + " :End of channel invite list\r\n")
 # define RPL_INVITING(guest, channel) (guest + " :" + channel + "\r\n")
 
 
@@ -38,13 +42,13 @@
 # define NTC_JOIN(channel) ("JOIN :" + channel)
 # define NTC_PART(channel) ("PART :" + channel)
 # define NTC_PART_MSG(channel, msg) ("PART " + channel + " :\"" + msg +"\"")
-# define NTC_PRIVMSG(dest, msg) ("PRIVMSG " + dest + " " + msg)
-# define NTC_NOTICE(dest, msg) ("NOTICE " + dest + " " + msg)
+# define NTC_PRIVMSG(dest, msg) ("PRIVMSG " + dest + " :" + msg)
+# define NTC_NOTICE(dest, msg) ("NOTICE " + dest + " :" + msg)
 # define NTC_QUIT(msg) (" QUIT :Quit: " + msg)
 # define NTC_TOPIC(channel, topic) ("TOPIC " + channel + " :" + topic)
 # define NTC_CHANMODE(channel, mode) ("MODE " + channel + " :" + mode)
 # define NTC_CHANMODE_ARG(channel, mode, arg) ("MODE " + channel + " " + mode + " :" + arg)
-# define NTC_KICK(channel, usr, reason) ("KICK " + channel  + " " + usr + " " + reason)
+# define NTC_KICK(channel, usr, reason) ("KICK " + channel  + " " + usr + " :" + reason)
 # define NTC_INVITE(channel, usr) ("INVITE " + usr  + " :" + channel)
 
 // ERRORS
@@ -100,13 +104,19 @@ class eExc : public exception {
 		const char * _strerror;
 };
 
-extern map<int, string>		err;	// errors list
+# define NUMERIC_MAX			1000
+# define NUMERIC_PREFIX_LEN	(sizeof(SERVER_NAME) + 5)	// ":mfirc 353 "
+
+extern string		err[NUMERIC_MAX];	// errors list
 
 int		display_usage( void );
 void    define_errors( void );
-void    send_error( User u, int errn, string cmd );
-void    send_reply( User u, int rpln, string reply );
-void	send_notice_channel(User &u, Channel *c, string notice);
-void    send_notice( User from, User to, string notice );
+void	send_msg( User &u, string const &msg );
+void	send_msg( User &u, SharedBuf const &msg );
+void    send_error( User &u, int errn, string const &cmd );
+void    send_reply( User &u, int rpln, string const &reply );
+void	send_names( User &u, string const &chan, string const &list );
+void	send_notice_channel(User &u, Channel *c, string const &notice, User *except = NULL);
+void    send_notice( User &from, User &to, string const &notice );
 
 #endif
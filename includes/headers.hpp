@@ -4,13 +4,28 @@
 # define SERVER_NAME        "mfirc" 
 # define DEFAULT_HOST       "127.0.0.1"
 # define AVAILABLE_USER_MODES "iswo"
-# define AVAILABLE_CHANNEL_MODES "opsitnmlbvk"
-# define BACKLOG			5
-# define MAXCLI				5
+# define AVAILABLE_CHANNEL_MODES "opsitnmlbvkeI"
+# define BACKLOG			128
+# define MAXCLI				4096
 # define BUFSIZE			128
+# define SENDQ_MAX			262144
+# define SENDQ_IOV			64
+# define POOL_SLAB_SIZE		65536	// Bytes per pool slab
+# define POOL_SLAB_MIN		8		// Objects per pool slab, whatever their size
+# define IO_CHUNK			4096	// Input ring or output chunk
+# define IO_LINE			(MSG_MAXLEN + 32)	// One shared line and its header
+# define LINEBUF_SIZE		IO_CHUNK	// Power of two
+# define MSG_MAXLEN			512		// CR-LF included
+# define MSG_MAXPARAMS		15
 # define SERVER_VERSION		"0.7.13"
+# define PING_FREQ			120		// Seconds of silence before a PING
+# define PING_TIMEOUT		60		// Seconds to answer it
+# define REG_TIMEOUT		30		// Seconds to send NICK and USER
+# define FLOOD_BURST		20		// Command cost a client may pipeline at once
+# define FLOOD_RATE			2		// Then per second
+# define CMD_QUANTUM		8		// Lines run per client and loop round
 # define MAX_CHAN_PER_USR	10
-# define MAX_USR_PER_CHAN	10
+# define MAX_USR_PER_CHAN	65536
 # define MAX_USR_NICK_LEN	20
 # define MAX_CHAN_NAME_LEN	200
 
@@ -24,6 +39,8 @@
 
 # include <iostream>
 # include <vector>
+# include <new>
+# include <deque>
 # include <map>
 # include <string>
 # include <exception>
@@ -31,6 +48,7 @@
 # include <iterator>
 # include <cerrno>
 # include <cstring>
+# include <cstddef>
 # include <cstdlib>
 # include <ctime>
 # include <algorithm>
@@ -38,6 +56,7 @@
 # include <iomanip>
 # include <sys/types.h>
 # include <sys/socket.h>
+# include <sys/uio.h>
 # include <arpa/inet.h>
 # include <netdb.h>
 # include <unistd.h>
@@ -47,10 +66,39 @@
 # include <signal.h>
 # include <fcntl.h>
 # include <poll.h>
+# include <pthread.h>
+# ifdef __linux__
+#  include <sys/epoll.h>
+#  if defined(__has_include)
+#   if __has_include(<linux/io_uring.h>)
+#    define HAS_IO_URING
+#    include <linux/io_uring.h>
+#    include <sys/mman.h>
+#    include <sys/syscall.h>
+#   endif
+#  endif
+# endif
+# if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && defined(__SSE2__)
+#  define HAS_X86_SIMD
+#  include <immintrin.h>
+# endif
 
 using namespace std;
 
 # include "colors.hpp"
+# include "Poller.hpp"
+# include "Pool.hpp"
+# include "SharedBuf.hpp"
+# include "SendQ.hpp"
+# include "scan.hpp"
+# include "LineBuf.hpp"
+# include "ConnTable.hpp"
+# include "TimerWheel.hpp"
+# include "NameIndex.hpp"
+# include "BanMask.hpp"
+# include "ModeSet.hpp"
+# include "Membership.hpp"
+# include "Message.hpp"
 # include "User.hpp"
 # include "Server.hpp"
 # include "Channel.hpp"
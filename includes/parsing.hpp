@@ -5,9 +5,22 @@
 # include "Server.hpp"
 
 map<string, string> parser( int n_params, char *params[] );
-int 				parsing( vector<string> args, User &usr, Server &srv );
+int 				parsing( Message const & msg, User &usr, Server &srv );
 map<string, string>	conf_file( char *path );
 
-typedef void (*FnPtr)(vector<string>, User&, Server&);
+typedef void (*FnPtr)(Message const &, User&, Server&);
+
+struct Command
+{
+	char const *	name;
+	FnPtr			fn;
+	size_t			min_params;
+	int				err;			// Sent when there are fewer params
+	bool			registered;		// Refused before registration
+	int				cost;			// Flood control weight
+};
+
+Command const *		find_command( StrView const & name );
+bool				set_command_costs( string const & list );
 
 #endif
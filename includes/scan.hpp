@@ -0,0 +1,13 @@
+#ifndef SCAN_HPP
+# define SCAN_HPP
+
+# include "headers.hpp"
+
+// Byte scanning of the input path. On x86 the kernels are picked once at
+// startup: AVX2 when the CPU has it, SSE2 otherwise, plain loops elsewhere.
+
+size_t			scan_eol( char const * p, size_t n );
+size_t			scan_delims( char const * p, size_t n, unsigned short * offs );
+char const *	scan_name( void );
+
+#endif
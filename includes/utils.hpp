@@ -5,7 +5,6 @@
 
 
 string			ft_join(vector<string> str, string sep, int begin=0);
-bool			ft_match( string const &str, string const &pattern );
 
 void get_infos(const string &str, string &nickname, string &username, string &hostname);
 
@@ -20,11 +19,12 @@ bool				is_digit( string s );
 bool				is_alpha( string s );
 bool				is_alnum( string s );
 bool				is_upper( string s );
+uint64_t			monotonic_ms( void );
 string				trim(const string& str, const string& whitespace = " \t");
 vector<string>  	ft_split(string str, string sep);
 struct in_addr  	get_in_addr(struct sockaddr *sa);
 void 				add_to_pfds(struct pollfd *pfds[], int newfd, int *fd_count, int *fd_size);
-void				messageoftheday( Server &srv, User usr );
+void				messageoftheday( Server &srv, User &usr );
 
 ostream				&operator<<(ostream & stream, User const &User);
 
@@ -0,0 +1,103 @@
+#include "headers.hpp"
+
+BanMask::BanMask( void ) : _mask(), _prefix(), _suffix(), _middle(),
+	_min_len(0), _star(false)
+{
+}
+
+BanMask::BanMask( string const & mask ) : _mask(mask), _prefix(), _suffix(),
+	_middle(), _min_len(0), _star(false)
+{
+	string	folded = irc_fold(mask);
+	size_t	first = folded.find('*');
+
+	if (first == string::npos) {
+		_prefix = folded;
+		_min_len = folded.size();
+		return ;
+	}
+	_star = true;
+
+	size_t	last = folded.rfind('*');
+
+	_prefix = folded.substr(0, first);
+	_suffix = folded.substr(last + 1);
+	_min_len = _prefix.size() + _suffix.size();
+	for (size_t i = first + 1; i < last; ) {
+		size_t	end = folded.find('*', i);
+
+		if (end > i) {
+			_middle.push_back(folded.substr(i, end - i));
+			_min_len += end - i;
+		}
+		i = end + 1;
+	}
+}
+
+BanMask::BanMask( BanMask const &src )
+{
+	*this = src;
+}
+
+BanMask::~BanMask( void )
+{
+}
+
+BanMask				&BanMask::operator=( BanMask const &rhs )
+{
+	_mask = rhs._mask;
+	_prefix = rhs._prefix;
+	_suffix = rhs._suffix;
+	_middle = rhs._middle;
+	_min_len = rhs._min_len;
+	_star = rhs._star;
+
+	return (*this);
+}
+
+/*								GETTERS										*/
+
+string const		&BanMask::getMask( void ) const
+{
+	return _mask;
+}
+
+/*								MEMBERS FUNCTIONS							*/
+
+// Same length piece of glob without stars, '?' takes any byte
+static bool			piece_at( char const * s, string const & piece )
+{
+	for (size_t i = 0; i < piece.size(); i++)
+		if (piece[i] != '?' && piece[i] != s[i])
+			return false;
+	return true;
+}
+
+bool				BanMask::matches( string const & folded ) const
+{
+	size_t	len = folded.size();
+
+	if (len < _min_len || (!_star && len != _min_len))
+		return false;
+	if (!piece_at(folded.data(), _prefix))
+		return false;
+	if (!_star)
+		return true;
+	if (!piece_at(folded.data() + len - _suffix.size(), _suffix))
+		return false;
+
+	// Leftmost fit of each piece leaves the most room to the next ones
+	size_t	pos = _prefix.size();
+	size_t	end = len - _suffix.size();
+
+	for (size_t i = 0; i < _middle.size(); i++) {
+		string const &	piece = _middle[i];
+
+		while (pos + piece.size() <= end && !piece_at(folded.data() + pos, piece))
+			pos++;
+		if (pos + piece.size() > end)
+			return false;
+		pos += piece.size();
+	}
+	return true;
+}
@@ -1,81 +1,81 @@
 #include "headers.hpp"
 
-Channel::Channel( void ) {
-	vector<string> banned_nicks;
-	vector<string> banned_usernames;
-	vector<string> banned_hostnames;
-
-	_banned["nick"] = banned_nicks;
-	_banned["user"] = banned_usernames;
-	_banned["host"] = banned_hostnames;
-
+// Every join and part takes or gives back a node, under the server lock
+static Pool<Membership>	g_memberships;
+
+// Cold state of the channels that have some
+static Pool<ChannelInfo>	g_chan_info;
+static vector<BanMask> const	g_no_masks;
+static string const			g_none;
+
+Channel::Channel( void ) :
+		_id(0),
+		_slot(0),
+		_members(NULL),
+		_members_tail(NULL),
+		_nb_members(0),
+		_modes(),
+		_limit(MAX_USR_PER_CHAN),
+		_ban_gen(1),
+		_has_key(false),
+		_has_topic(false),
+		_info(NULL)
+{
 	time_t now = time(0);
 	_creation_date = (INTMAX_T)now;
-
-	_topic_when = (INTMAX_T)now;
-	_topic_who = NULL;
 }
 
 Channel::Channel(string name) :
 		_name(TRUNC(name, MAX_CHAN_NAME_LEN)),
-		_key(""),
+		_id(0),
+		_slot(0),
+		_members(NULL),
+		_members_tail(NULL),
+		_nb_members(0),
+		_modes(),
+		_limit(MAX_USR_PER_CHAN),
+		_ban_gen(1),
 		_has_key(false),
-		_topic(""),
 		_has_topic(false),
-		_mode(""),
-		_limit(MAX_USR_PER_CHAN)
+		_info(NULL)
 {
-	vector<string> banned_nicks;
-	vector<string> banned_usernames;
-	vector<string> banned_hostnames;
-
-	_banned["nick"] = banned_nicks;
-	_banned["user"] = banned_usernames;
-	_banned["host"] = banned_hostnames;
-
 	time_t now = time(0);
 	_creation_date = (INTMAX_T)now;
-
-	_topic_when = (INTMAX_T)now;
-	_topic_who = NULL;
 }
 
 Channel::Channel(string name, string key, string topic, User * usr, string mode) : 
 		_name(TRUNC(name, MAX_CHAN_NAME_LEN)),
-		_key(key),
+		_id(0),
+		_slot(0),
+		_members(NULL),
+		_members_tail(NULL),
+		_nb_members(0),
+		_modes(mode),
+		_limit(MAX_USR_PER_CHAN),
+		_ban_gen(1),
 		_has_key(false),
-		_topic(topic),
 		_has_topic(false),
-		_mode(mode)
+		_info(NULL)
 {
-	vector<string> banned_nicks;
-	vector<string> banned_usernames;
-	vector<string> banned_hostnames;
-
-	_banned["nick"] = banned_nicks;
-	_banned["user"] = banned_usernames;
-	_banned["host"] = banned_hostnames;
-
 	time_t now = time(0);
 	_creation_date = (INTMAX_T)now;
 
 	if ( key != "" ) {
-		_has_key = true;
-		_mode += "k";
+		setKey(key);
+		_modes.add('k');
 	}
-
-	_topic_when = (INTMAX_T)now;
-	_topic_who = usr;
-	
 	if ( topic != "" )
-		_has_topic = true;
+		setTopic(topic, usr);
 
-	addMember(usr);
-	addOper(usr);
+	addMember(usr, MEMBER_OP);
 }
 
 Channel::~Channel() {
-	
+
+	while ( _members )
+		deleteMember( _members->user );
+	if ( _info )
+		g_chan_info.release(_info);
 }
 
 Channel & Channel::operator=(Channel const & src) {
@@ -83,10 +83,10 @@ Channel & Channel::operator=(Channel const & src) {
 	if (this != &src) {
 		this->_name = src.getName();
 		this->_has_key = src.getHasKey();
-		this->_key = src.getKey();
 		this->_has_topic = src.getHasTopic();
-		this->_topic = src.getTopic();
-		this->_mode = src.getMode();
+		this->_modes = src._modes;
+		if ( src._info )
+			info() = *src._info;
 	}
 	return *this;
 }
@@ -95,8 +95,16 @@ string const		&Channel::getName() const {
 	return _name;
 }
 
+unsigned long		Channel::getId( void ) const {
+	return _id;
+}
+
+size_t				Channel::getSlot( void ) const {
+	return _slot;
+}
+
 string const		&Channel::getKey() const {
-	return _key;
+	return _info ? _info->key : g_none;
 }
 
 bool const			&Channel::getHasKey() const {
@@ -104,27 +112,27 @@ bool const			&Channel::getHasKey() const {
 }
 
 size_t				Channel::getNbMembers() const {
-	return _members.size();
+	return _nb_members;
 }
 
 string const		&Channel::getTopic() const {
-	return _topic;
+	return _info ? _info->topic : g_none;
 }
 
 bool const			&Channel::getHasTopic() const {
 	return _has_topic;
 }
 
-vector<User*> const	&Channel::getMembers() const {
+Membership			*Channel::getMembers() const {
 	return _members;
 }
 
-vector<User*> const	&Channel::getOper() const {
-	return _oper;
+string const		&Channel::getMode( void ) const {
+	return _modes.str();
 }
 
-string const		&Channel::getMode( void ) const {
-	return _mode;
+ModeSet const		&Channel::getModes( void ) const {
+	return _modes;
 }
 
 string const Channel::getCreationDate() const {
@@ -136,21 +144,29 @@ string const Channel::getCreationDate() const {
 
 string const Channel::getTopicWhen() const {
 	ostringstream s;
-	s << fixed << _topic_when;
+	s << fixed << (_info ? _info->topic_when : _creation_date);
 	string date = s.str();
 	return date;
 }
 
-User *					Channel::getTopicWho( void ) const {
-	return _topic_who;
+string const			&Channel::getTopicWho( void ) const {
+	return _info ? _info->topic_who : g_none;
 }
 
 size_t 			Channel::getLimit( void ) const {
 	return _limit;
 }
 
-vector<string> const	&Channel::getBanMask( void ) const {
-	return _banned_mask;
+vector<BanMask> const	&Channel::getBanMask( void ) const {
+	return _info ? _info->bans : g_no_masks;
+}
+
+vector<BanMask> const	&Channel::getExceptMask( void ) const {
+	return _info ? _info->excepts : g_no_masks;
+}
+
+vector<BanMask> const	&Channel::getInvexMask( void ) const {
+	return _info ? _info->invexs : g_no_masks;
 }
 
 void    			Channel::setName(string const & name) {
@@ -158,33 +174,39 @@ void    			Channel::setName(string const & name) {
 }
 
 void    			Channel::setKey(string const & key) {
-	_key = key;
+	info().key = key;
 	_has_key = true;
 }
 
+// The setter is kept by name, it may be gone when the topic is shown
 void    			Channel::setTopic(string const & topic, User * u) {
-	_topic = topic;
+	info().topic = topic;
 	_has_topic = true;
-	_topic_who = u;
+	_info->topic_who = u->fci();
 	time_t now = time(0);
-	_topic_when = (INTMAX_T)now;
+	_info->topic_when = (INTMAX_T)now;
 }
 
 void    			Channel::unsetTopic(User * u) {
-	_topic = "";
+	info().topic = "";
 	_has_topic = false;
-	_topic_who = u;
+	_info->topic_who = u->fci();
 	time_t now = time(0);
-	_topic_when = (INTMAX_T)now;
+	_info->topic_when = (INTMAX_T)now;
 }
 
 void    			Channel::unsetKey() {
-	_key = "";
+	if ( _info )
+		_info->key = "";
 	_has_key = false;
 }
 
 void				Channel::setMode( string mode ) {
-	_mode = mode;
+	_modes = ModeSet(mode);
+}
+
+void				Channel::setModes( ModeSet const & modes ) {
+	_modes = modes;
 }
 
 void    			Channel::setLimit( int limit ) {
@@ -195,138 +217,271 @@ void    			Channel::setLimit( int limit ) {
 		_limit = MAX_USR_PER_CHAN;
 }
 
-void				Channel::addMember( User * usr ) {
-	_members.push_back(usr);
+void				Channel::setId( unsigned long id ) {
+	_id = id;
 }
 
-void				Channel::deleteMember( User * usr ) {
-	
-	for ( size_t i = 0; i < this->getNbMembers(); i++ ) {
-		if ( usr->getNick() == _members[i]->getNick() ) {
-			if ( isOper( *usr ) )
-				deleteOper( usr );
-			_members.erase(_members.begin() + i);
-		}
+void				Channel::setSlot( size_t slot ) {
+	_slot = slot;
+}
+
+ChannelInfo			&Channel::info( void ) {
+
+	if ( !_info ) {
+		_info = new (g_chan_info.alloc()) ChannelInfo();
+		_info->topic_when = _creation_date;
 	}
+	return *_info;
+}
+
+// The channel owns the node, the user only links it in its own list
+Membership			*Channel::addMember( User * usr, unsigned flags ) {
+
+	Membership *	m = usr->getMembership(*this);
+
+	if ( m )
+		return m;
+	m = new (g_memberships.alloc()) Membership();
+	m->user = usr;
+	m->chan = this;
+	m->flags = flags;
+	m->chan_prev = _members_tail;
+	m->chan_next = NULL;
+	if ( _members_tail )
+		_members_tail->chan_next = m;
+	else
+		_members = m;
+	_members_tail = m;
+	_nb_members++;
+	usr->linkChannel(m);
+	return m;
+}
+
+void				Channel::deleteMember( User * usr ) {
+
+	Membership *	m = usr->getMembership(*this);
+
+	if ( !m )
+		return ;
+	usr->unlinkChannel(m);
+	if ( m->chan_prev )
+		m->chan_prev->chan_next = m->chan_next;
+	else
+		_members = m->chan_next;
+	if ( m->chan_next )
+		m->chan_next->chan_prev = m->chan_prev;
+	else
+		_members_tail = m->chan_prev;
+	_nb_members--;
+	g_memberships.release(m);
+}
+
+// Roles only exist on members
+void				Channel::setMemberFlag( User * usr, unsigned flag, bool on ) {
+
+	Membership *	m = usr->getMembership(*this);
+
+	if ( !m )
+		return ;
+	if ( on )
+		m->flags |= flag;
+	else
+		m->flags &= ~flag;
 }
 
 void				Channel::addModerator( User * usr ) {
-	_moderators.push_back(usr);
+	setMemberFlag(usr, MEMBER_VOICE, true);
 }
 
 void				Channel::deleteModerator( User * usr ) {
-	
-	for ( size_t i = 0; i < _moderators.size(); i++ ) {
-		if ( usr->getNick() == _moderators[i]->getNick() )
-			_moderators.erase(_moderators.begin() + i);
-	}
+	setMemberFlag(usr, MEMBER_VOICE, false);
 }
 
 void				Channel::addOper( User * usr ) {
-	_oper.push_back(usr);
+	setMemberFlag(usr, MEMBER_OP, true);
 }
 
 void				Channel::deleteOper( User * usr ) {
-	
-	for ( size_t i = 0; i < _oper.size(); i++ ) {
-		if ( usr->getNick() == _oper[i]->getNick() )
-			_oper.erase(_oper.begin() + i);
+	setMemberFlag(usr, MEMBER_OP, false);
+}
+
+// Masks are compared with the casemapping, setting one twice is a no-op
+static bool			add_mask( vector<BanMask> & list, string const & mask ) {
+
+	for ( size_t i = 0; i < list.size(); i++ )
+		if ( irc_equals(list[i].getMask(), mask) )
+			return false;
+	list.push_back(BanMask(mask));
+	return true;
+}
+
+static bool			delete_mask( vector<BanMask> & list, string const & mask ) {
+
+	for ( size_t i = 0; i < list.size(); i++ ) {
+		if ( irc_equals(list[i].getMask(), mask) ) {
+			list.erase(list.begin() + i);
+			return true;
+		}
 	}
+	return false;
 }
 
 void				Channel::ban( string mask ) {
-	_banned_mask.push_back(mask);
+	if ( add_mask(info().bans, mask) )
+		_ban_gen++;
 }
 
 void				Channel::unban( string mask ) {
-	
-	for ( size_t i = 0; i < _banned_mask.size(); i++ ) {
-		if ( mask == _banned_mask[i] )
-			_banned_mask.erase(_banned_mask.begin() + i);
-	}
+	if ( _info && delete_mask(_info->bans, mask) )
+		_ban_gen++;
+}
+
+void				Channel::addExcept( string mask ) {
+	if ( add_mask(info().excepts, mask) )
+		_ban_gen++;
 }
 
+void				Channel::deleteExcept( string mask ) {
+	if ( _info && delete_mask(_info->excepts, mask) )
+		_ban_gen++;
+}
+
+void				Channel::addInvex( string mask ) {
+	add_mask(info().invexs, mask);
+}
+
+void				Channel::deleteInvex( string mask ) {
+	if ( _info )
+		delete_mask(_info->invexs, mask);
+}
+
+bool				Channel::matchBans( User const & usr ) const {
+
+	if ( !_info || _info->bans.empty() )
+		return false;
+
+	vector<BanMask> const &	bans = _info->bans;
+	vector<BanMask> const &	excepts = _info->excepts;
+	string					fci = irc_fold(usr.fci());
+	size_t					i = 0;
+
+	while ( i < bans.size() && !bans[i].matches(fci) )
+		i++;
+	if ( i == bans.size() )
+		return false;
+	for ( i = 0; i < excepts.size(); i++ )
+		if ( excepts[i].matches(fci) )
+			return false;
+	return true;
+}
+
+// Members keep their verdict until the lists or their nick!user@host change
 bool				Channel::isBanned( User const & usr ) {
 
-	for ( size_t i = 0; i < _banned_mask.size(); i++ ) {
-		if ( ft_match(usr.fci(), _banned_mask[i]) )
-			return true;
+	Membership *	m = usr.getMembership(*this);
+
+	if ( !m )
+		return matchBans(usr);
+	if ( m->ban_gen != _ban_gen || m->ident_gen != usr.getIdentGen() ) {
+		m->banned = matchBans(usr);
+		m->ban_gen = _ban_gen;
+		m->ident_gen = usr.getIdentGen();
 	}
-	return false;
+	return m->banned;
 }
 
+// Users that left meanwhile are dropped, the list only holds live ones
 void				Channel::invite( User * usr ) {
-	_invited_usrs.push_back(usr);
+
+	vector< PoolRef<User> > &	invited = info().invited;
+	size_t						n = 0;
+
+	for ( size_t i = 0; i < invited.size(); i++ )
+		if ( Pool<User>::get(invited[i]) && invited[i].ptr != usr )
+			invited[n++] = invited[i];
+	invited.resize(n);
+	invited.push_back(Pool<User>::ref(usr));
 }
 
+// Invited by a member, or matching a +I mask
 bool				Channel::isInvited( User const & usr ) {
 
-	if ( find( _invited_usrs.begin(), _invited_usrs.end(), &usr) != _invited_usrs.end() )
-		return true;
+	if ( !_info )
+		return false;
+
+	vector< PoolRef<User> > const &	invited = _info->invited;
+
+	// A released user's slot may hold a new connection, the generation
+	// tells them apart
+	for ( size_t i = 0; i < invited.size(); i++ )
+		if ( Pool<User>::get(invited[i]) == &usr )
+			return true;
+	if ( _info->invexs.empty() )
+		return false;
+
+	string		fci = irc_fold(usr.fci());
+
+	for ( size_t i = 0; i < _info->invexs.size(); i++ )
+		if ( _info->invexs[i].matches(fci) )
+			return true;
 	return false;
 }
 
-bool					Channel::isInviteOnly( void ) {
+bool					Channel::isInviteOnly( void ) const {
 
-	return this->getMode().find("i") != string::npos;
+	return _modes.has('i');
 }
 
-bool					Channel::isPrivate( void ) {
+bool					Channel::isPrivate( void ) const {
 
-	return this->getMode().find("p") != string::npos;
+	return _modes.has('p');
 }
 
-bool					Channel::isSecret( void ) {
+bool					Channel::isSecret( void ) const {
 
-	return this->getMode().find("s") != string::npos;
+	return _modes.has('s');
 }
 
-bool					Channel::isModerated( void ) {
+bool					Channel::isModerated( void ) const {
 
-	return this->getMode().find("m") != string::npos;
+	return _modes.has('m');
 }
 
-bool					Channel::isTopicSettableByOperOnly( void ) {
+bool					Channel::isTopicSettableByOperOnly( void ) const {
 
-	return this->getMode().find("t") != string::npos;
+	return _modes.has('t');
 }
 
 string				Channel::getMembersList( void ) {
 
 	string reply;
 
-	for ( size_t i = 0; i < _members.size(); i++ ) {
-		if (this->isOper(*_members[i]))
+	for ( Membership *m = _members; m; m = m->chan_next ) {
+		if ( m->flags & MEMBER_OP )
 			reply += "@";
-		reply += _members[i]->getNick();
-		if ( i < _members.size() - 1 )
+		reply += m->user->getNick();
+		if ( m->chan_next )
 			reply += " ";
 	}
 	return reply;
 }
 
 bool				Channel::isOnChann( User const & usr ) {
-	for ( size_t i = 0; i < _members.size(); i++ ) {
-		if ( usr.getNick() == _members[i]->getNick())
-			return true;
-	}
-	return false;
+	return usr.getMembership(*this) != NULL;
 }
 
 bool				Channel::isOper( User const & usr ) {
-	for ( size_t i = 0; i < _oper.size(); i++ ) {
-		if ( usr.getNick() == _oper[i]->getNick())
-			return true;
-	}
-	return false;
+
+	Membership *	m = usr.getMembership(*this);
+
+	return m && (m->flags & MEMBER_OP);
 }
 
 bool				Channel::isModerator( User const & usr ) {
-	for ( size_t i = 0; i < _moderators.size(); i++ ) {
-		if ( usr.getNick() == _moderators[i]->getNick())
-			return true;
-	}
-	return false;
+
+	Membership *	m = usr.getMembership(*this);
+
+	return m && (m->flags & MEMBER_VOICE);
 }
 
 string		Channel::MembersToString( User const & u, Server const & srv ) {
@@ -337,8 +492,8 @@ string		Channel::MembersToString( User const & u, Server const & srv ) {
 	s	<< ":" << srv.getName() << " 353 " << u.getNick()
 		<< " = " << _name << " :@";
 
-	for (vector<User *>::iterator it = _members.begin(); it != _members.end(); it++)
-		s << (*it)->getNick() << " ";
+	for (Membership *m = _members; m; m = m->chan_next)
+		s << m->user->getNick() << " ";
 
 	s << "\r\n";
 
@@ -352,7 +507,12 @@ string		Channel::MembersToString( User const & u, Server const & srv ) {
 ostream & operator<<(ostream & stream, Channel &Channel) {
 
 	stream << "Channel: " << Channel.getName();
-	stream << " created by " << Channel.getOper()[0]->getNick();
+	Membership *	m = Channel.getMembers();
+
+	while (m && !(m->flags & MEMBER_OP))
+		m = m->chan_next;
+	if (m)
+		stream << " created by " << m->user->getNick();
 	if (Channel.getHasKey())
 		stream << " is private (key: " << Channel.getKey() << ")";
 	else
@@ -0,0 +1,80 @@
+#include "headers.hpp"
+
+ConnTable::ConnTable( void ) : _slots(), _size(0), _rings(), _chunks()
+{
+}
+
+ConnTable::~ConnTable( void )
+{
+	for (size_t i = 0; i < _slots.size(); i++)
+		_rings.release(_slots[i].in);
+}
+
+/*								GETTERS										*/
+
+size_t				ConnTable::size( void ) const
+{
+	return _size;
+}
+
+Pool<IoChunk> const	&ConnTable::getChunks( void ) const
+{
+	return _chunks;
+}
+
+Conn *				ConnTable::get( int fd )
+{
+	if (fd < 0 || (size_t)fd >= _slots.size() || !_slots[fd].user)
+		return NULL;
+	return &_slots[fd];
+}
+
+Conn *				ConnTable::get( ConnRef const & ref )
+{
+	Conn *	c = get(ref.fd);
+
+	return c && c->gen == ref.gen ? c : NULL;
+}
+
+ConnRef				ConnTable::ref( int fd ) const
+{
+	ConnRef	r;
+
+	r.fd = fd;
+	r.gen = (size_t)fd < _slots.size() ? _slots[fd].gen : 0;
+	return r;
+}
+
+/*								MEMBERS FUNCTIONS							*/
+
+ConnRef				ConnTable::open( int fd, User * u )
+{
+	if ((size_t)fd >= _slots.size()) {
+		Conn	empty = { NULL, NULL, 0, false, 0 };
+
+		_slots.resize(fd + 1, empty);
+	}
+
+	Conn &	c = _slots[fd];
+
+	c.user = u;
+	c.in = new (_rings.alloc()) LineBuf(_chunks);
+	c.events = 0;
+	c.queued = false;
+	c.gen++;
+	_size++;
+	return ref(fd);
+}
+
+void				ConnTable::close( int fd )
+{
+	Conn *	c = get(fd);
+
+	if (!c)
+		return ;
+	_rings.release(c->in);
+	c->in = NULL;
+	c->user = NULL;
+	c->gen++;
+	_size--;
+}
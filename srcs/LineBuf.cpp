@@ -0,0 +1,117 @@
+#include "headers.hpp"
+
+# define LINEBUF_MASK		(LINEBUF_SIZE - 1)
+
+LineBuf::LineBuf( Pool<IoChunk> & chunks ) : _chunks(chunks), _buf(NULL),
+	_head(0), _tail(0), _scan(0), _discard(false)
+{
+}
+
+LineBuf::~LineBuf( void )
+{
+	_chunks.release(reinterpret_cast<IoChunk *>(_buf));
+}
+
+/*								GETTERS										*/
+
+// Bytes received and not handed out yet, partial line included
+size_t				LineBuf::size( void ) const
+{
+	return _tail - _head;
+}
+
+/*								MEMBERS FUNCTIONS							*/
+
+// Contiguous free space at the end of the ring for the next read, NULL
+// once it is full. A ring without a chunk borrows one.
+char *				LineBuf::room( size_t & len )
+{
+	size_t			t = _tail & LINEBUF_MASK;
+
+	if (_tail - _head == LINEBUF_SIZE) {
+		len = 0;
+		return NULL;
+	}
+	if (!_buf)
+		_buf = static_cast<char *>(_chunks.alloc());
+	len = min(LINEBUF_SIZE - (_tail - _head), (size_t)LINEBUF_SIZE - t);
+	return _buf + t;
+}
+
+// n bytes were read into room()
+void				LineBuf::filled( size_t n )
+{
+	_tail += n;
+}
+
+// Next complete line, without its terminator. Empty lines are skipped, so
+// both "\r\n" and a bare "\n" end a line. The view stays valid until the
+// next call.
+bool				LineBuf::next( char const * & line, size_t & len )
+{
+	while (1) {
+
+		// Only look at what arrived since the last scan
+		while (_scan != _tail) {
+			size_t	s = _scan & LINEBUF_MASK;
+			size_t	n = min(_tail - _scan, (size_t)LINEBUF_SIZE - s);
+			size_t	i = scan_eol(_buf + s, n);
+
+			_scan += i;
+			if (i < n)
+				break ;
+		}
+
+		if (_scan == _tail) {
+			if (_discard) {
+				_head = _tail;
+				giveBack();
+				return false;
+			}
+			if (_tail - _head < MSG_MAXLEN - 2) {
+				giveBack();
+				return false;
+			}
+			// No terminator in sight: cut it and drop the rest
+			line = view(_head, MSG_MAXLEN - 2);
+			len = MSG_MAXLEN - 2;
+			_head = _tail;
+			_discard = true;
+			return true;
+		}
+
+		size_t		start = _head;
+		size_t		n = min(_scan - _head, (size_t)MSG_MAXLEN - 2);
+		bool		skip = _discard;
+
+		_head = ++_scan;
+		_discard = false;
+		if (skip || !n)
+			continue ;
+		line = view(start, n);
+		len = n;
+		return true;
+	}
+}
+
+// Contiguous bytes of [start, start + len), len is at most MSG_MAXLEN
+char const *		LineBuf::view( size_t start, size_t len )
+{
+	size_t			s = start & LINEBUF_MASK;
+	size_t			first = LINEBUF_SIZE - s;
+
+	if (len <= first)
+		return _buf + s;
+	memcpy(_line, _buf + s, first);
+	memcpy(_line + first, _buf, len - first);
+	return _line;
+}
+
+// Positions only matter relative to each other, an empty ring can go
+void				LineBuf::giveBack( void )
+{
+	if (_buf && _head == _tail) {
+		_chunks.release(reinterpret_cast<IoChunk *>(_buf));
+		_buf = NULL;
+	}
+}
@@ -0,0 +1,144 @@
+#include "headers.hpp"
+
+/*								STRVIEW										*/
+
+StrView::StrView( void ) : ptr(""), len(0) {}
+
+StrView::StrView( char const * p, size_t n ) : ptr(p), len(n) {}
+
+size_t				StrView::size( void ) const
+{
+	return len;
+}
+
+bool				StrView::empty( void ) const
+{
+	return len == 0;
+}
+
+char				StrView::operator[]( size_t i ) const
+{
+	return i < len ? ptr[i] : '\0';
+}
+
+string				StrView::str( void ) const
+{
+	return string(ptr, len);
+}
+
+bool				StrView::operator==( char const * s ) const
+{
+	return strlen(s) == len && !memcmp(ptr, s, len);
+}
+
+bool				StrView::operator==( string const & s ) const
+{
+	return s.size() == len && !memcmp(ptr, s.data(), len);
+}
+
+bool				StrView::operator!=( char const * s ) const
+{
+	return !(*this == s);
+}
+
+bool				StrView::operator!=( string const & s ) const
+{
+	return !(*this == s);
+}
+
+/*								CONSTRUCTORS								*/
+
+Message::Message( void ) : _tags(), _prefix(), _command(), _nparams(0), _trailing(false) {}
+
+/*								GETTERS										*/
+
+StrView const &		Message::getTags( void ) const
+{
+	return _tags;
+}
+
+StrView const &		Message::getPrefix( void ) const
+{
+	return _prefix;
+}
+
+StrView const &		Message::getCommand( void ) const
+{
+	return _command;
+}
+
+size_t				Message::size( void ) const
+{
+	return _nparams;
+}
+
+StrView const &		Message::operator[]( size_t i ) const
+{
+	return _params[i];
+}
+
+bool				Message::hasTrailing( void ) const
+{
+	return _trailing;
+}
+
+/*								MEMBERS FUNCTIONS							*/
+
+// Tokenizes a line without its CR-LF, at most MSG_MAXLEN bytes. Token ends
+// come from the precomputed delimiter offsets, spaces in a row count as
+// one. Past MSG_MAXPARAMS - 1 params the last one takes the rest of the line
+// (RFC 2812). Returns false when there is no command.
+bool				Message::parse( char const * line, size_t len )
+{
+	unsigned short	offs[MSG_MAXLEN];
+	size_t			n = scan_delims(line, len, offs);
+	size_t			d = 0;
+	size_t			pos = 0;
+
+	*this = Message();
+	while (1) {
+
+		while (pos < len && line[pos] == ' ')
+			pos++;
+		if (pos == len)
+			break ;
+
+		if (!_command.empty() && (line[pos] == ':' || _nparams == MSG_MAXPARAMS - 1)) {
+			_trailing = (line[pos] == ':');
+			pos += _trailing;
+			_params[_nparams++] = StrView(line + pos, len - pos);
+			break ;
+		}
+
+		// Next space after pos
+		while (d < n && (offs[d] < pos || line[offs[d]] != ' '))
+			d++;
+
+		size_t		end = d < n ? offs[d] : len;
+		StrView		tok(line + pos, end - pos);
+
+		if (_command.empty() && _tags.empty() && _prefix.empty() && tok[0] == '@')
+			_tags = StrView(tok.ptr + 1, tok.len - 1);
+		else if (_command.empty() && _prefix.empty() && tok[0] == ':')
+			_prefix = StrView(tok.ptr + 1, tok.len - 1);
+		else if (_command.empty())
+			_command = tok;
+		else
+			_params[_nparams++] = tok;
+		pos = end;
+	}
+	return !_command.empty();
+}
+
+// Params from `from` on, space separated, as they were sent
+string				Message::join( size_t from ) const
+{
+	string			res;
+
+	for (size_t i = from; i < _nparams; i++) {
+		if (i != from)
+			res += " ";
+		res.append(_params[i].ptr, _params[i].len);
+	}
+	return res;
+}
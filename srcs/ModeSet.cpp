@@ -0,0 +1,72 @@
+#include "headers.hpp"
+
+ModeSet::ModeSet( void ) : _bits(0), _str()
+{
+}
+
+ModeSet::ModeSet( string const & modes ) : _bits(0), _str()
+{
+	for (size_t i = 0; i < modes.size(); i++)
+		_bits |= mode_bit(modes[i]);
+	update();
+}
+
+ModeSet::ModeSet( ModeSet const &src )
+{
+	*this = src;
+}
+
+ModeSet::~ModeSet( void )
+{
+}
+
+ModeSet				&ModeSet::operator=( ModeSet const &rhs )
+{
+	_bits = rhs._bits;
+	_str = rhs._str;
+
+	return (*this);
+}
+
+/*								GETTERS										*/
+
+string const		&ModeSet::str( void ) const
+{
+	return _str;
+}
+
+/*								MEMBERS FUNCTIONS							*/
+
+void				ModeSet::update( void )
+{
+	_str.clear();
+	for (char c = 'A'; c <= 'Z'; c++)
+		if (has(c))
+			_str += c;
+	for (char c = 'a'; c <= 'z'; c++)
+		if (has(c))
+			_str += c;
+}
+
+// Both return whether the set changed
+bool				ModeSet::add( char c )
+{
+	uint64_t	bit = mode_bit(c);
+
+	if (!bit || (_bits & bit))
+		return false;
+	_bits |= bit;
+	update();
+	return true;
+}
+
+bool				ModeSet::remove( char c )
+{
+	uint64_t	bit = mode_bit(c);
+
+	if (!(_bits & bit))
+		return false;
+	_bits &= ~bit;
+	update();
+	return true;
+}
@@ -0,0 +1,46 @@
+#include "headers.hpp"
+
+// A-Z and []\^ fold to a-z and {}|~, everything else is itself
+static unsigned char	g_casemap[256];
+
+static bool			init_casemap( void )
+{
+	for (int c = 0; c < 256; c++)
+		g_casemap[c] = c;
+	for (int c = 'A'; c <= '^'; c++)
+		g_casemap[c] = c + 32;
+	return true;
+}
+
+static bool const	g_casemap_ready = init_casemap();
+
+string				irc_fold( string const & s )
+{
+	string	res(s);
+
+	for (size_t i = 0; i < res.size(); i++)
+		res[i] = g_casemap[(unsigned char)res[i]];
+	return res;
+}
+
+bool				irc_equals( string const & a, string const & b )
+{
+	if (a.size() != b.size())
+		return false;
+	for (size_t i = 0; i < a.size(); i++)
+		if (g_casemap[(unsigned char)a[i]] != g_casemap[(unsigned char)b[i]])
+			return false;
+	return true;
+}
+
+// FNV-1a over the folded bytes
+size_t				irc_hash( string const & s )
+{
+	size_t	h = 2166136261u;
+
+	for (size_t i = 0; i < s.size(); i++) {
+		h ^= g_casemap[(unsigned char)s[i]];
+		h *= 16777619u;
+	}
+	return h;
+}
@@ -0,0 +1,250 @@
+#include "headers.hpp"
+
+/*								FACTORY										*/
+
+Poller *			Poller::create( string const & name )
+{
+	if (name == "poll")
+		return new PollPoller();
+# ifdef __linux__
+	if (name == "epoll")
+		return new EpollPoller();
+# endif
+# ifdef HAS_IO_URING
+	if (name == "io_uring") {
+		try {
+			return new UringPoller();
+		}
+		catch (const exception& e) {
+			// Seccomp'd containers and old kernels: keep serving with the default
+			cerr << RED << "io_uring unavailable (" << e.what() << "), falling back" << RESET << endl;
+			return create(defaultName());
+		}
+	}
+# endif
+	throw eExc("Unknown or unsupported poller backend");
+}
+
+char const *		Poller::defaultName( void )
+{
+# ifdef __linux__
+	return "epoll";
+# else
+	return "poll";
+# endif
+}
+
+/*								I/O BATCH									*/
+
+// Readiness backends: the listener is watched like any fd, requests are
+// plain syscalls made right away.
+void				Poller::addListener( int fd )
+{
+	add(fd, POLLER_IN);
+}
+
+void				Poller::queueRecv( int fd, char * buf, size_t len, ssize_t * res )
+{
+	*res = recv(fd, buf, len, 0);
+	if (*res == -1)
+		*res = -errno;
+}
+
+void				Poller::queueSend( int fd, struct msghdr * msg, int flags, ssize_t * res )
+{
+	*res = sendmsg(fd, msg, flags);
+	if (*res == -1)
+		*res = -errno;
+}
+
+void				Poller::submit( void )
+{
+}
+
+/*								POLL										*/
+
+PollPoller::PollPoller( void ) : _pfds(), _index() {}
+
+PollPoller::~PollPoller( void ) {}
+
+char const *		PollPoller::getName( void ) const
+{
+	return "poll";
+}
+
+bool				PollPoller::isEdgeTriggered( void ) const
+{
+	return false;
+}
+
+static short		to_poll_events( int events )
+{
+	short	ev = 0;
+
+	if (events & POLLER_IN)
+		ev |= POLLIN;
+	if (events & POLLER_OUT)
+		ev |= POLLOUT;
+	return ev;
+}
+
+void				PollPoller::add( int fd, int events )
+{
+	struct pollfd	p;
+
+	if ((size_t)fd >= _index.size())
+		_index.resize(fd + 1, -1);
+	p.fd = fd;
+	p.events = to_poll_events(events);
+	p.revents = 0;
+	_index[fd] = _pfds.size();
+	_pfds.push_back(p);
+}
+
+void				PollPoller::modify( int fd, int events )
+{
+	if ((size_t)fd < _index.size() && _index[fd] != -1)
+		_pfds[_index[fd]].events = to_poll_events(events);
+}
+
+void				PollPoller::remove( int fd )
+{
+	if ((size_t)fd >= _index.size() || _index[fd] == -1)
+		return ;
+
+	int		idx = _index[fd];
+
+	_pfds[idx] = _pfds.back();
+	_index[_pfds[idx].fd] = idx;
+	_pfds.pop_back();
+	_index[fd] = -1;
+}
+
+int					PollPoller::wait( vector<PollerEvent> & ready, int timeout )
+{
+	ready.clear();
+
+	int		n = poll(&_pfds[0], _pfds.size(), timeout);
+
+	if (n == -1) {
+		if (errno == EINTR)
+			return 0;
+		throw eExc(strerror(errno));
+	}
+
+	for (size_t i = 0; i < _pfds.size() && (int)ready.size() < n; i++) {
+		if (!_pfds[i].revents)
+			continue ;
+
+		PollerEvent	e;
+
+		e.fd = _pfds[i].fd;
+		e.events = 0;
+		if (_pfds[i].revents & POLLIN)
+			e.events |= POLLER_IN;
+		if (_pfds[i].revents & POLLOUT)
+			e.events |= POLLER_OUT;
+		if (_pfds[i].revents & (POLLERR | POLLHUP | POLLNVAL))
+			e.events |= POLLER_ERR;
+		ready.push_back(e);
+	}
+	return ready.size();
+}
+
+/*								EPOLL										*/
+
+# ifdef __linux__
+
+EpollPoller::EpollPoller( void ) : _epfd(epoll_create1(0)), _events(64)
+{
+	if (_epfd == -1)
+		throw eExc(strerror(errno));
+}
+
+EpollPoller::~EpollPoller( void )
+{
+	close(_epfd);
+}
+
+char const *		EpollPoller::getName( void ) const
+{
+	return "epoll";
+}
+
+bool				EpollPoller::isEdgeTriggered( void ) const
+{
+	return true;
+}
+
+static uint32_t		to_epoll_events( int events )
+{
+	uint32_t	ev = EPOLLET | EPOLLRDHUP;
+
+	if (events & POLLER_IN)
+		ev |= EPOLLIN;
+	if (events & POLLER_OUT)
+		ev |= EPOLLOUT;
+	return ev;
+}
+
+void				EpollPoller::add( int fd, int events )
+{
+	struct epoll_event	ev;
+
+	memset(&ev, 0, sizeof ev);
+	ev.events = to_epoll_events(events);
+	ev.data.fd = fd;
+	if (epoll_ctl(_epfd, EPOLL_CTL_ADD, fd, &ev) == -1)
+		throw eExc(strerror(errno));
+}
+
+void				EpollPoller::modify( int fd, int events )
+{
+	struct epoll_event	ev;
+
+	memset(&ev, 0, sizeof ev);
+	ev.events = to_epoll_events(events);
+	ev.data.fd = fd;
+	if (epoll_ctl(_epfd, EPOLL_CTL_MOD, fd, &ev) == -1)
+		throw eExc(strerror(errno));
+}
+
+void				EpollPoller::remove( int fd )
+{
+	// Closing the fd would drop it from the set anyway, ignore ENOENT
+	epoll_ctl(_epfd, EPOLL_CTL_DEL, fd, NULL);
+}
+
+int					EpollPoller::wait( vector<PollerEvent> & ready, int timeout )
+{
+	ready.clear();
+
+	int		n = epoll_wait(_epfd, &_events[0], _events.size(), timeout);
+
+	if (n == -1) {
+		if (errno == EINTR)
+			return 0;
+		throw eExc(strerror(errno));
+	}
+
+	for (int i = 0; i < n; i++) {
+		PollerEvent	e;
+
+		e.fd = _events[i].data.fd;
+		e.events = 0;
+		if (_events[i].events & (EPOLLIN | EPOLLRDHUP))
+			e.events |= POLLER_IN;
+		if (_events[i].events & EPOLLOUT)
+			e.events |= POLLER_OUT;
+		if (_events[i].events & (EPOLLERR | EPOLLHUP))
+			e.events |= POLLER_ERR;
+		ready.push_back(e);
+	}
+
+	// Full batch: let the next wakeup collect more at once
+	if ((size_t)n == _events.size())
+		_events.resize(_events.size() * 2);
+	return n;
+}
+
+# endif
@@ -0,0 +1,239 @@
+#include "headers.hpp"
+
+SendQ::SendQ( size_t max ) : _bufs(), _offset(0), _size(0), _max(max),
+	_exceeded(false), _scheduled(false)
+{
+}
+
+SendQ::SendQ( SendQ const &src )
+{
+	*this = src;
+}
+
+SendQ::~SendQ( void )
+{
+}
+
+SendQ				&SendQ::operator=( SendQ const &rhs )
+{
+	_bufs = rhs._bufs;
+	_offset = rhs._offset;
+	_size = rhs._size;
+	_max = rhs._max;
+	_exceeded = rhs._exceeded;
+	_scheduled = rhs._scheduled;
+
+	return (*this);
+}
+
+/*								GETTERS										*/
+
+size_t				SendQ::size( void ) const
+{
+	return _size;
+}
+
+bool				SendQ::empty( void ) const
+{
+	return _size == 0;
+}
+
+bool				SendQ::exceeded( void ) const
+{
+	return _exceeded;
+}
+
+bool				SendQ::isScheduled( void ) const
+{
+	return _scheduled;
+}
+
+/*								SETTERS										*/
+
+void				SendQ::setMax( size_t max )
+{
+	_max = max;
+}
+
+void				SendQ::setScheduled( bool scheduled )
+{
+	_scheduled = scheduled;
+}
+
+/*								MEMBERS FUNCTIONS							*/
+
+// Returns false once the ceiling is reached: the message and everything
+// after it are dropped, the owner disconnects the client on next flush.
+// Copied at the end of the last chunk, a new one is chained when full.
+bool				SendQ::push( string const & msg )
+{
+	char *			p = reserve(msg.size());
+
+	if (!p)
+		return false;
+	memcpy(p, msg.data(), msg.size());
+	commit(msg.size());
+	return true;
+}
+
+// Broadcasts share the same buffer between all the recipients' queues
+bool				SendQ::push( SharedBuf const & msg )
+{
+	if (_exceeded)
+		return false;
+	if (_size + msg.size() > _max) {
+		_exceeded = true;
+		return false;
+	}
+	_bufs.push_back(msg);
+	_size += msg.size();
+	return true;
+}
+
+// Room for n bytes at the end of the queue, to be formatted in place and
+// committed. Small replies pile up in the same pooled chunk instead of
+// getting a buffer each. NULL once the ceiling is reached, like push().
+char *				SendQ::reserve( size_t n )
+{
+	if (_exceeded)
+		return NULL;
+	if (_size + n > _max) {
+		_exceeded = true;
+		return NULL;
+	}
+	if (_bufs.empty() || !_bufs.back().unique() || _bufs.back().room() < n)
+		_bufs.push_back(SharedBuf(max(n, SharedBuf::chunkRoom())));
+	return _bufs.back().tail();
+}
+
+void				SendQ::commit( size_t n )
+{
+	_bufs.back().grow(n);
+	_size += n;
+}
+
+// Writes as much as the socket takes. Returns -1 on a socket error, 0
+// otherwise; check empty() to know if everything went out.
+int					SendQ::flush( int fd )
+{
+	deque<SharedBuf>	bufs;
+	size_t				offset;
+
+	detach(bufs, offset);
+
+	ssize_t				sent = write(fd, bufs, offset);
+
+	attach(bufs, offset, sent == -1 ? 0 : sent);
+	return sent == -1 ? -1 : 0;
+}
+
+void				SendQ::clear( void )
+{
+	_bufs.clear();
+	_offset = 0;
+	_size = 0;
+}
+
+// Hands the queued buffers over to be written without the server lock.
+// They still count in size(), lines queued meanwhile go after them.
+void				SendQ::detach( deque<SharedBuf> & bufs, size_t & offset )
+{
+	bufs.clear();
+	bufs.swap(_bufs);
+	offset = _offset;
+	_offset = 0;
+}
+
+// Takes back what detach() handed over once sent bytes were written, in
+// front of what was queued meanwhile. Dropping buffers releases them, so
+// this is under the server lock again. True if all of them went out.
+bool				SendQ::attach( deque<SharedBuf> & bufs, size_t offset, size_t sent )
+{
+	drop(bufs, offset, sent);
+	_size -= sent;
+	if (bufs.empty())
+		return true;
+	if (_bufs.empty())
+		_bufs.swap(bufs);
+	else {
+		_bufs.insert(_bufs.begin(), bufs.begin(), bufs.end());
+		bufs.clear();
+	}
+	_offset = offset;
+	return false;
+}
+
+// One sendmsg() at a time until the socket is full. Only reads the
+// buffers, so it needs no lock: a buffer that left its queue is never
+// written into again. Returns the bytes sent, -1 on a socket error.
+ssize_t				SendQ::write( int fd, deque<SharedBuf> const & bufs, size_t offset )
+{
+	struct iovec	iov[SENDQ_IOV];
+	struct msghdr	msg;
+	size_t			total = 0;
+	size_t			first = 0;			// Next buffer to send, from offset
+
+	while (first < bufs.size()) {
+
+		int			flags;
+		size_t		batch = gather(bufs, first, offset, msg, iov, flags);
+		ssize_t		sent = sendmsg(fd, &msg, flags);
+
+		if (sent == -1) {
+			if (errno == EAGAIN || errno == EWOULDBLOCK)
+				return total;
+			if (errno == EINTR)
+				continue ;
+			return -1;
+		}
+		total += sent;
+		// Socket buffer full
+		if ((size_t)sent < batch)
+			return total;
+		first += msg.msg_iovlen;
+		offset = 0;
+	}
+	return total;
+}
+
+// Points msg at up to SENDQ_IOV buffers from bufs[first] + offset and
+// returns how many bytes that is
+size_t				SendQ::gather( deque<SharedBuf> const & bufs, size_t first, size_t offset,
+						struct msghdr & msg, struct iovec * iov, int & flags )
+{
+	size_t			n = 0;
+	size_t			batch = 0;
+
+	for (size_t i = first; i < bufs.size() && n < SENDQ_IOV; i++, n++) {
+		size_t	off = n ? 0 : offset;
+
+		iov[n].iov_base = const_cast<char *>(bufs[i].data() + off);
+		iov[n].iov_len = bufs[i].size() - off;
+		batch += iov[n].iov_len;
+	}
+	flags = 0;
+# ifdef MSG_MORE
+	// More lines follow right away, don't push a partial segment
+	if (first + n < bufs.size())
+		flags |= MSG_MORE;
+# endif
+	memset(&msg, 0, sizeof msg);
+	msg.msg_iov = iov;
+	msg.msg_iovlen = n;
+	return batch;
+}
+
+void				SendQ::drop( deque<SharedBuf> & bufs, size_t & offset, size_t n )
+{
+	while (n) {
+		size_t	left = bufs.front().size() - offset;
+
+		if (n < left) {
+			offset += n;
+			return ;
+		}
+		n -= left;
+		bufs.pop_front();
+		offset = 0;
+	}
+}
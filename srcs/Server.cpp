@@ -8,13 +8,29 @@ Server::Server(string port, string pwd) :
 		_pwd(pwd),
 		_host(DEFAULT_HOST),
 		_servinfo(NULL),
+		_poller_name(Poller::defaultName()),
+		_max_clients(MAXCLI),
+		_nb_shards(1),
+		_sendq_max(SENDQ_MAX),
+		_ping_freq(PING_FREQ),
+		_ping_timeout(PING_TIMEOUT),
+		_reg_timeout(REG_TIMEOUT),
+		_flood_burst(FLOOD_BURST),
+		_flood_rate(FLOOD_RATE),
+		_shards(),
+		_user_pool(),
+		_chan_pool(),
 		_users(),
-		_usr_buf(),
+		_nicks(),
+		_channels(),
+		_chan_index(),
+		_next_chan_id(1),
 		_irc_operators(),
 		_motd("")
 {
 	time_t now = time(0);
 	_creation_date = pop_back(ctime(&now));
+	pthread_mutex_init(&_lock, NULL);
 }
 
 Server::Server(string port, string pwd, string host=DEFAULT_HOST, string motd="",
@@ -24,12 +40,28 @@ Server::Server(string port, string pwd, string host=DEFAULT_HOST, string motd=""
 		_pwd(pwd),
 		_host(host),
 		_servinfo(NULL),
+		_poller_name(Poller::defaultName()),
+		_max_clients(MAXCLI),
+		_nb_shards(1),
+		_sendq_max(SENDQ_MAX),
+		_ping_freq(PING_FREQ),
+		_ping_timeout(PING_TIMEOUT),
+		_reg_timeout(REG_TIMEOUT),
+		_flood_burst(FLOOD_BURST),
+		_flood_rate(FLOOD_RATE),
+		_shards(),
+		_user_pool(),
+		_chan_pool(),
 		_users(),
-		_usr_buf(),
+		_nicks(),
+		_channels(),
+		_chan_index(),
+		_next_chan_id(1),
 		_motd(motd)
 {
 	time_t now = time(0);
 	_creation_date = pop_back(ctime(&now));
+	pthread_mutex_init(&_lock, NULL);
 
 	vector<string>	cred = ft_split(operators, "|");
 
@@ -41,7 +73,16 @@ Server::Server(string port, string pwd, string host=DEFAULT_HOST, string motd=""
 	}
 }
 
-Server::~Server() {}
+Server::~Server() {
+
+	for (size_t i = 0; i < _shards.size(); i++) {
+		delete _shards[i]->poller;
+		close(_shards[i]->wake[0]);
+		close(_shards[i]->wake[1]);
+		delete _shards[i];
+	}
+	pthread_mutex_destroy(&_lock);
+}
 
 Server 						&Server::operator=(Server const & src) {
 
@@ -101,6 +142,30 @@ map<string, string>	const	&Server::getIRCOperators() const {
 	return _irc_operators;
 }
 
+void						Server::setOptions( map<string, string> & opts ) {
+
+	if (opts.count("POLLER"))
+		_poller_name = opts["POLLER"];
+	if (opts.count("MAXCLI"))
+		_max_clients = atoi(opts["MAXCLI"].c_str());
+	if (opts.count("SHARDS"))
+		_nb_shards = max(1, atoi(opts["SHARDS"].c_str()));
+	if (opts.count("SENDQ"))
+		_sendq_max = atoi(opts["SENDQ"].c_str());
+	if (opts.count("PING_FREQ"))
+		_ping_freq = max(1, atoi(opts["PING_FREQ"].c_str()));
+	if (opts.count("PING_TIMEOUT"))
+		_ping_timeout = max(1, atoi(opts["PING_TIMEOUT"].c_str()));
+	if (opts.count("REG_TIMEOUT"))
+		_reg_timeout = max(1, atoi(opts["REG_TIMEOUT"].c_str()));
+	if (opts.count("FLOOD_BURST"))
+		_flood_burst = max(1, atoi(opts["FLOOD_BURST"].c_str()));
+	if (opts.count("FLOOD_RATE"))
+		_flood_rate = max(1, atoi(opts["FLOOD_RATE"].c_str()));
+	if (opts.count("FLOOD_COST") && !set_command_costs(opts["FLOOD_COST"]))
+		throw eExc("FLOOD_COST: expected COMMAND:cost|...");
+}
+
 ostream & operator<<(ostream & stream, Server &Server) {
 
 	stream << "name: " << Server.getName() << endl;
@@ -148,6 +213,18 @@ int				Server::setSocket( struct addrinfo * p ) {
 		cout << RED << "KO" << RESET << endl;
 		throw eExc(strerror(errno));
 	}
+	// Every shard binds its own listener, the kernel spreads the connections
+	if (_nb_shards > 1) {
+# ifdef SO_REUSEPORT
+		if (setsockopt(_sockfd, SOL_SOCKET, SO_REUSEPORT, &yes, sizeof(int)) == -1) {
+			cout << RED << "KO" << RESET << endl;
+			throw eExc(strerror(errno));
+		}
+# else
+		cout << RED << "KO" << RESET << endl;
+		throw eExc("SO_REUSEPORT is required to run more than one shard");
+# endif
+	}
 	if (fcntl(_sockfd, F_SETFL, O_NONBLOCK) == -1) {
 		cout << RED << "KO" << RESET << endl;
 		throw eExc(strerror(errno));
@@ -183,180 +260,577 @@ void				Server::initConn() {
 			continue ;
 		break ;
 	}
-	freeaddrinfo(_servinfo);
 
 	if ( !p ) {
+		freeaddrinfo(_servinfo);
 		throw eExc("server: failed to bind");
 	}
 	this->listenHost();
 
+	for ( size_t i = 0; i < _nb_shards; i++ ) {
+		// Shard 0 uses the socket opened above, the others open their own
+		if ( i > 0 && (this->setSocket(p) || this->bindPort(p)) ) {
+			freeaddrinfo(_servinfo);
+			throw eExc("server: failed to bind shard listener");
+		}
+		if ( i > 0 )
+			this->listenHost();
+
+		Shard * sh = new Shard;
+
+		sh->id = i;
+		sh->sockfd = _sockfd;
+		sh->poller = NULL;
+		sh->srv = this;
+		sh->backlog_max = 0;
+		sh->backlog_bytes = 0;
+		sh->pools_seen = 0;
+		if (pipe(sh->wake) == -1 || fcntl(sh->wake[0], F_SETFL, O_NONBLOCK) == -1
+			|| fcntl(sh->wake[1], F_SETFL, O_NONBLOCK) == -1)
+			throw eExc(strerror(errno));
+		_shards.push_back(sh);
+	}
+	freeaddrinfo(_servinfo);
+
 	cout << BOLDGREEN  << "Server init success!!" << RESET << endl;
 	cout << YELLOW << "Listening for clients ..." << RESET << endl;
 }
 
-int				Server::sendData( int fd ) {
-	
-	int		dest_fd;
-	char    buf[BUFSIZE];
+// Called without the server lock: only touches the shard's own sockets.
+// Every connection gets one read per pass, the whole pass submitted at
+// once; those that got bytes go another pass, until their socket is
+// drained, closed or their ring is full. A client that sent its last
+// lines and hung up is then gone in the same round.
+void				Server::readInputs( Shard & sh, vector<Input> & inputs ) {
 
-	for ( int j = 0; j < _fd_count; j++ ) {
-		dest_fd = _poll[j].fd;
-		if ( dest_fd != _sockfd && dest_fd != fd )
-			if ( send(dest_fd, buf, BUFSIZE - 1, 0) == -1 )
-				throw eExc(strerror(errno));
+	bool			left = true;
+
+	for ( size_t i = 0; i < inputs.size(); i++ ) {
+		inputs[i].gone = false;
+		inputs[i].more = false;
+		// Closed since it was queued for reading
+		inputs[i].reading = sh.conns.get(inputs[i].ref) != NULL;
 	}
-	return 0;
-}
+	while (left) {
+		left = false;
+		for ( size_t i = 0; i < inputs.size(); i++ ) {
+			Input &		in = inputs[i];
 
-vector<string>  get_next_command( string &usr_buf, string buf )
-{
-	string			s(usr_buf + buf);
+			if (!in.reading)
+				continue ;
 
-	// Multiple commands on one line
-	if (count(s.begin(), s.end(), '\n') > 0)
-	{
-		usr_buf = "";
-		vector<string> tmp = ft_split(s, "\n");
-		
-		// Delete \r in case of connection from irssi
-		for (vector<string>::iterator it = tmp.begin(); it != tmp.end(); ++it)
-			if ((*it)[0] == '\r')
-				(*it).erase(0, 1);
+			char *		buf = sh.conns.get(in.ref)->in->room(in.asked);
 
-		return tmp;
+			if (!buf) {
+				in.more = true;
+				in.reading = false;
+				continue ;
+			}
+			sh.poller->queueRecv(in.ref.fd, buf, in.asked, &in.res);
+		}
+		sh.poller->submit();
+		for ( size_t i = 0; i < inputs.size(); i++ ) {
+			Input &		in = inputs[i];
+
+			if (!in.reading)
+				continue ;
+			if (in.res == -EINTR) {
+				left = true;
+				continue ;
+			}
+			in.reading = false;
+			if (in.res == -EAGAIN || in.res == -EWOULDBLOCK)
+				continue ;
+			if (in.res <= 0) {
+				if (in.res < 0)
+					cerr << RED << "recv: " << strerror(-in.res) << RESET << endl;
+				in.gone = true;
+				continue ;
+			}
+			sh.conns.get(in.ref)->in->filled(in.res);
+			in.reading = true;
+			left = true;
+		}
 	}
-	else
-		usr_buf += buf;
-
-	return vector<string>();
 }
 
-int				Server::receiveData( int i ) {
-	
-	char    		buf[BUFSIZE];
-	int 			nbytes;
-	ostringstream	s;
-
-	memset(buf, 0, BUFSIZE);
-	nbytes = recv(_poll[i].fd, buf, BUFSIZE - 1, 0);
-	if (nbytes <= 0) {
-		if (!nbytes)
-			cout << BOLDWHITE << "❌ Client #" << _poll[i].fd << " gone away" << RESET << endl;
-		del_from_pfds(_poll[i].fd);
-		deleteUser( _users[i - 1] );
-		if (nbytes < 0)
-			throw eExc(strerror(errno));
-		return 1;
-	}
+void				Server::processData( Shard & sh, Input const & in ) {
 
-	vector<string>  v = get_next_command(_usr_buf[i - 1], buf);
-	if (!v.empty())
-		v.pop_back(); // Delete last empty line
+	Conn *			c = sh.conns.get(in.ref);
+	char const *	line;
+	size_t			len;
+	Message			msg;
 
-	if (v.size() > 0)
-		for (vector<string>::iterator it = v.begin(); it != v.end(); it++)
-			if (parsing(ft_split(*it, " "), *_users[i - 1], *this) == -1) {
-				return 1;
-			}
+	if (!c)
+		return ;
 
-	return 0;
-}
+	User *			usr = c->user;
+	LineBuf &		lb = *c->in;
+	bool			active = false;
+	size_t			n = 0;
 
-void				Server::acceptConn() {
+	c->queued = false;
 
-	struct sockaddr_in	host_addr;
+	// Fake lag: lines beyond the client's tokens wait in its ring
+	usr->refill(sh.now, _flood_rate, _flood_burst);
+	// At most a quantum per round, the others get their turn first
+	while (n < CMD_QUANTUM && usr->getTokens() > 0 && lb.next(line, len)) {
 
-	socklen_t addr_size = sizeof host_addr;
-	_newfd = accept(_sockfd, (struct sockaddr *)&host_addr, &addr_size);
-	if ( _newfd == -1 ) {
-		throw eExc(strerror(errno));
+		int			cost = 1;
+
+		active = true;
+		n++;
+		if (msg.parse(line, len))
+			cost = parsing(msg, *usr, *this);
+		// The command may have closed the connection (QUIT, bad PASS)
+		if (!sh.conns.get(in.ref))
+			return ;
+		usr->spend(cost);
+	}
+
+	// Any line proves the client alive: push its keepalive back
+	if (active && usr->isRegistered()) {
+		usr->setLastAct(time(0));
+		usr->setPingStatus(false);
+		sh.timers.schedule(&usr->getTimer(), sh.now + _ping_freq);
+	}
+
+	if (in.gone)
+		disconnect(*usr, "Connection closed");
+	else if (usr->getTokens() <= 0 && lb.size()) {
+		// Still sending faster than it is served once its ring is full
+		if (in.more)
+			disconnect(*usr, "Excess Flood");
+		else if (!usr->isLagged()) {
+			usr->setLagged(true);
+			sh.lagged.push_back(in.ref);
+		}
+	}
+	// Quantum used up or ring full: go on next round, unless its output is
+	// backed up; updateEvents() resumes it then
+	else if ((in.more || (n == CMD_QUANTUM && lb.size())) && (c->events & POLLER_IN)) {
+		sh.pending.push_back(in.ref);
+		sh.backlog_bytes += lb.size();
 	}
+}
+
+static void			log_client( int fd, struct sockaddr_in const & host_addr ) {
 
 	// inet_ntoa()
 	// function converts the Internet host address in, given in network
 	// byte order, to a string in IPv4 dotted-decimal notation.
-	cout << BOLDWHITE << "✅ New client #" << _newfd
+	cout << BOLDWHITE << "✅ New client #" << fd
 		 << " from " << inet_ntoa(host_addr.sin_addr)
 		 << ":" << ntohs(host_addr.sin_port) << RESET << endl;
 }
 
+// Called without the server lock: only touches the shard's own listener.
+// newfd is a connection the poller already accepted, -1 to accept here.
+void				Server::acceptConn( Shard & sh, vector<int> & accepted, int newfd ) {
+
+	struct sockaddr_in	host_addr;
+	socklen_t			addr_size = sizeof host_addr;
+
+	if ( newfd != -1 ) {
+		if ( getpeername(newfd, (struct sockaddr *)&host_addr, &addr_size) == -1 )
+			memset(&host_addr, 0, sizeof host_addr);
+		log_client(newfd, host_addr);
+		accepted.push_back(newfd);
+		return ;
+	}
+	// Accept every pending connection: the epoll backend is edge-triggered
+	while (1) {
+		addr_size = sizeof host_addr;
+		newfd = accept(sh.sockfd, (struct sockaddr *)&host_addr, &addr_size);
+		if ( newfd == -1 ) {
+			if (errno == EAGAIN || errno == EWOULDBLOCK || errno == ECONNABORTED)
+				return ;
+			throw eExc(strerror(errno));
+		}
+		log_client(newfd, host_addr);
+		accepted.push_back(newfd);
+	}
+}
+
 /* pollfd utils */
 
-bool				Server::add_to_pfds(int newfd)
+bool				Server::add_to_pfds( Shard & sh, int newfd )
 {
-	if (_fd_count == MAXCLI + 1) {
+	if (_users.size() >= _max_clients) {
 		cout << RED << "Max number of clients reached" << RESET << endl;
 		string msg = ERR_SERVERISFULL(_host);
 		send(newfd, &msg[0], msg.size(), 0);
+		close(newfd);
 		return false;
 	}
-	_poll[_fd_count].fd = newfd;
-	_poll[_fd_count].events = POLLIN;
-	_fd_count++;
+	if (fcntl(newfd, F_SETFL, O_NONBLOCK) == -1) {
+		close(newfd);
+		throw eExc(strerror(errno));
+	}
+	sh.poller->add(newfd, POLLER_IN);
 	return true;
 }
 
-void				Server::del_from_pfds(int fd)
+void				Server::del_from_pfds( Shard & sh, int fd )
 {
-	int idx = 0;
-	while ( idx < _fd_count) {
-		if (_poll[idx].fd == fd)
-			break;
-		idx++;
-	}
-	
-	if (idx == _fd_count )
-		return ;
-	
-	_poll[idx] = _poll[_fd_count - 1];
-	_poll[idx].events = POLLIN;
+	sh.poller->remove(fd);
+	sh.conns.close(fd);
 	close(fd);
-	_fd_count--;
+}
+
+/* output utils */
 
+// Called with the server lock held, from any shard
+void				Shard::wantFlush( User & u )
+{
+	if (u.getSendQ().isScheduled())
+		return ;
+	u.getSendQ().setScheduled(true);
+	flush.push_back(conns.ref(u.getFd()));
+	if (!pthread_equal(thread, pthread_self()))
+		if (write(wake[1], "", 1) == -1 && errno != EAGAIN)
+			cerr << RED << "wake: " << strerror(errno) << RESET << endl;
 }
 
-void				Server::run() {
+// Stop reading commands from a client while its output is backed up, and
+// watch for writability only while there is something left to send.
+void				Server::updateEvents( User & u )
+{
+	Shard *	sh = u.getShard();
+	Conn *	c = sh->conns.get(u.getFd());
+	int		events = u.getSendQ().empty() ? POLLER_IN : POLLER_OUT;
+
+	if (c && events != c->events) {
+		sh->poller->modify(u.getFd(), events);
+		c->events = events;
+		// Lines left while reading was paused won't get a new event
+		if (events == POLLER_IN && c->in->size())
+			sh->pending.push_back(sh->conns.ref(u.getFd()));
+	}
+}
 
-	_poll[0].fd = _sockfd;
-	_poll[0].events = POLLIN;
-	_fd_count = 1;
+// Under the lock: takes the queued buffers of every connection to flush.
+// They stay scheduled until attached back, so one connection is never
+// written twice in a round. The Output slots are kept from one round to
+// the next.
+size_t				Server::detachOutput( Shard & sh, vector<Output> & out )
+{
+	size_t	n = 0;
 
-	while (1) {
+	// Disconnecting a client queues QUITs, the list may grow while we iterate
+	for ( size_t i = 0; i < sh.flush.size(); i++ ) {
 
-		int poll_count = poll(_poll, _fd_count, -1);
+		Conn *	c = sh.conns.get(sh.flush[i]);
 
-		if (poll_count == -1)
-			throw eExc(strerror(errno));
+		// Closed, maybe reused, since it was queued
+		if (!c)
+			continue ;
 
-		for ( int i = 0; i < _fd_count; i++ ) {
-			// If something happened on fd i
-			if ( _poll[i].revents & POLLIN ) {
-				// New connection / New user
-				if ( _poll[i].fd == _sockfd ) {
-					this->acceptConn();
-					// Add new fd that made the connection (Up to 5)
-					if ( add_to_pfds(_newfd) ) {
-						// Create new user
-						_users.push_back(new User(_newfd));
-						break ;
-					}
-				}
-				else
-					this->receiveData(i);
+		User *	u = c->user;
+		SendQ &	q = u->getSendQ();
+
+		if (q.exceeded()) {
+			q.setScheduled(false);
+			q.clear();
+			disconnect(*u, "SendQ exceeded");
+			continue ;
+		}
+		if (n == out.size())
+			out.push_back(Output());
+		out[n].ref = sh.flush[i];
+		q.detach(out[n].bufs, out[n].offset);
+		n++;
+	}
+	sh.flush.clear();
+	return n;
+}
+
+// Without the lock: the syscalls of one shard don't hold up the others.
+// One sendmsg per connection per pass, the whole pass submitted at once;
+// those that sent all they gathered go another pass with the next buffers.
+void				Server::writeOutput( Poller & p, vector<Output> & out, size_t n )
+{
+	bool	left = true;
+
+	for ( size_t i = 0; i < n; i++ ) {
+		out[i].sent = 0;
+		out[i].first = 0;
+		out[i].skip = out[i].offset;
+		out[i].writing = !out[i].bufs.empty();
+	}
+	while (left) {
+		left = false;
+		for ( size_t i = 0; i < n; i++ ) {
+			Output &	o = out[i];
+			int			flags;
+
+			if (!o.writing)
+				continue ;
+			o.batch = SendQ::gather(o.bufs, o.first, o.skip, o.msg, o.iov, flags);
+			p.queueSend(o.ref.fd, &o.msg, flags, &o.res);
+		}
+		p.submit();
+		for ( size_t i = 0; i < n; i++ ) {
+			Output &	o = out[i];
+
+			if (!o.writing)
+				continue ;
+			if (o.res == -EINTR) {
+				left = true;
+				continue ;
+			}
+			o.writing = false;
+			if (o.res == -EAGAIN || o.res == -EWOULDBLOCK)
+				continue ;
+			if (o.res < 0) {
+				o.sent = -1;
+				o.error = -o.res;
+				continue ;
+			}
+			o.sent += o.res;
+			// Socket buffer full
+			if ((size_t)o.res < o.batch)
+				continue ;
+			o.first += o.msg.msg_iovlen;
+			o.skip = 0;
+			if (o.first < o.bufs.size()) {
+				o.writing = true;
+				left = true;
 			}
 		}
 	}
 }
 
-//	If fd was registered
-bool					Server::is_registered( User & usr )
+// Under the lock again: releases what went out, requeues the rest
+void				Server::attachOutput( Shard & sh, vector<Output> & out, size_t n )
 {
-	for (vector<User*>::const_iterator it = _users.begin(); it != _users.end(); ++it) {
-		if ((*it)->getFd() == usr.getFd())
-			return true;
+	for ( size_t i = 0; i < n; i++ ) {
+
+		User *	u = sh.conns.get(out[i].ref)->user;
+		SendQ &	q = u->getSendQ();
+		bool	drained = q.attach(out[i].bufs, out[i].offset, out[i].sent == -1 ? 0 : out[i].sent);
+
+		q.setScheduled(false);
+		if (out[i].sent == -1)
+			disconnect(*u, strerror(out[i].error));
+		// Lines queued meanwhile are sent next round
+		else if (drained && !q.empty())
+			sh.wantFlush(*u);
+		else
+			updateEvents(*u);
+	}
+}
+
+// Unregistered clients are dropped, silent ones get a PING, then are
+// dropped if they stay silent.
+void				Server::expireTimers( Shard & sh, vector<ConnRef> & expired )
+{
+	for ( size_t i = 0; i < expired.size(); i++ ) {
+
+		Conn *	c = sh.conns.get(expired[i]);
+
+		if (!c)
+			continue ;
+
+		User &	u = *c->user;
+
+		if (!u.isRegistered())
+			disconnect(u, "Registration timeout");
+		else if (!u.getPingStatus()) {
+			send_msg(u, "PING :" + _host + "\r\n");
+			u.setPingStatus(true);
+			sh.timers.schedule(&u.getTimer(), sh.now + _ping_timeout);
+		}
+		else
+			disconnect(u, "Ping timeout");
+	}
+	expired.clear();
+}
+
+// Logs the I/O pools every time one of them grows: chunks in use, most in
+// use at once and allocated
+void				Server::reportPools( Shard & sh )
+{
+	Pool<IoChunk> const &	in = sh.conns.getChunks();
+	size_t					cap = in.capacity() + g_out_chunks.capacity() + g_out_lines.capacity();
+
+	if (cap <= sh.pools_seen)
+		return ;
+	sh.pools_seen = cap;
+	cout << YELLOW << "Shard " << sh.id << " I/O pools:"
+		 << " input " << in.size() << "/" << in.peak() << "/" << in.capacity()
+		 << ", output chunks " << g_out_chunks.size() << "/" << g_out_chunks.peak()
+		 << "/" << g_out_chunks.capacity()
+		 << ", lines " << g_out_lines.size() << "/" << g_out_lines.peak()
+		 << "/" << g_out_lines.capacity() << RESET << endl;
+}
+
+void *				Server::shardMain( void * arg ) {
+
+	Shard *	sh = static_cast<Shard *>(arg);
+
+	try {
+		sh->srv->runShard(*sh);
+	}
+	catch (const exception& e) {
+		cerr << BOLDRED << "shard " << sh->id << ": " << e.what() << RESET << endl;
+		exit(EXIT_FAILURE);
+	}
+	return NULL;
+}
+
+void				Server::runShard( Shard & sh ) {
+
+	vector<PollerEvent>	ready;
+	vector<int>			accepted;
+	vector<int>			writable;
+	vector<Input>		inputs;
+	vector<ConnRef>		pending;
+	vector<ConnRef>		expired;
+	vector<ConnRef>		lagged;
+	vector<Output>		out;
+	size_t				n;
+	bool				flushing = false;
+	char				drain[64];
+
+	while (1) {
+
+		uint64_t		now_ms = monotonic_ms();
+		int				timeout = sh.pending.empty() && !flushing ? sh.timers.timeout(now_ms) : 0;
+
+		// Lagged clients get tokens back every second
+		if (!sh.lagged.empty() && (timeout == -1 || timeout > (int)(1000 - now_ms % 1000)))
+			timeout = 1000 - now_ms % 1000;
+		// Don't sleep while some connections still have unread data or
+		// output to flush, nor past the next timeout
+		sh.poller->wait(ready, timeout);
+		sh.now = monotonic_ms() / 1000;
+		sh.timers.advance(sh.now, expired);
+
+		// I/O phase, lock free: accept and read what the shard owns
+		accepted.clear();
+		writable.clear();
+		inputs.clear();
+		pending.swap(sh.pending);
+		sh.pending.clear();
+		for ( size_t i = 0; i < pending.size(); i++ ) {
+			Conn *	c = sh.conns.get(pending[i]);
+
+			if (!c || c->queued)
+				continue ;
+			c->queued = true;
+			inputs.push_back(Input());
+			inputs.back().ref = pending[i];
+		}
+		for ( size_t i = 0; i < ready.size(); i++ ) {
+			if ( ready[i].events & POLLER_ACCEPT )
+				this->acceptConn(sh, accepted, ready[i].fd);
+			else if ( ready[i].fd == sh.sockfd )
+				this->acceptConn(sh, accepted, -1);
+			else if ( ready[i].fd == sh.wake[0] )
+				while (read(sh.wake[0], drain, sizeof drain) > 0)
+					;
+			else {
+				Conn *	c = sh.conns.get(ready[i].fd);
+
+				if ( ready[i].events & POLLER_OUT )
+					writable.push_back(ready[i].fd);
+				// Carried over connections were just read, once is enough
+				if ( (ready[i].events & (POLLER_IN | POLLER_ERR)) && !(c && c->queued) ) {
+					if ( c )
+						c->queued = true;
+					inputs.push_back(Input());
+					inputs.back().ref = sh.conns.ref(ready[i].fd);
+				}
+			}
+		}
+		this->readInputs(sh, inputs);
+
+		// Commands phase: users and channels are shared between shards
+		pthread_mutex_lock(&_lock);
+		try {
+			for ( size_t i = 0; i < accepted.size(); i++ ) {
+				if ( add_to_pfds(sh, accepted[i]) ) {
+					// Create new user
+					User * u = new (_user_pool.alloc()) User(accepted[i]);
+
+					u->setShard(&sh);
+					u->getSendQ().setMax(_sendq_max);
+					sh.conns.open(accepted[i], u);
+					sh.conns.get(accepted[i])->events = POLLER_IN;
+					u->getTimer().ref = sh.conns.ref(accepted[i]);
+					sh.timers.schedule(&u->getTimer(), sh.now + _reg_timeout);
+					u->setSlot(_users.size());
+					_users.push_back(u);
+				}
+			}
+			for ( size_t i = 0; i < writable.size(); i++ )
+				if ( Conn * c = sh.conns.get(writable[i]) )
+					sh.wantFlush(*c->user);
+			// Resume the lagged clients that got their tokens back
+			lagged.swap(sh.lagged);
+			sh.lagged.clear();
+			for ( size_t i = 0; i < lagged.size(); i++ ) {
+				Conn *	c = sh.conns.get(lagged[i]);
+
+				if (!c)
+					continue ;
+				c->user->setLagged(false);
+				if (c->queued)
+					continue ;
+				c->queued = true;
+				inputs.push_back(Input());
+				inputs.back().ref = lagged[i];
+				inputs.back().gone = false;
+				inputs.back().more = false;
+			}
+			sh.backlog_bytes = 0;
+			for ( size_t i = 0; i < inputs.size(); i++ )
+				this->processData(sh, inputs[i]);
+			this->expireTimers(sh, expired);
+			if ( sh.pending.size() > sh.backlog_max ) {
+				sh.backlog_max = sh.pending.size();
+				cout << YELLOW << "Shard " << sh.id << " backlog: " << sh.backlog_max
+					 << " connection(s), " << sh.backlog_bytes << " bytes queued" << RESET << endl;
+			}
+			this->reportPools(sh);
+			// Replies queued by this shard and handed over by the others,
+			// sent with the lock released
+			if (( n = this->detachOutput(sh, out) )) {
+				pthread_mutex_unlock(&_lock);
+				writeOutput(*sh.poller, out, n);
+				pthread_mutex_lock(&_lock);
+				this->attachOutput(sh, out, n);
+			}
+			// QUITs of the clients just dropped, lines queued while writing
+			flushing = !sh.flush.empty();
+		}
+		catch (...) {
+			pthread_mutex_unlock(&_lock);
+			throw ;
+		}
+		pthread_mutex_unlock(&_lock);
 	}
-	
-	return false;
+}
+
+void				Server::run() {
+
+	for ( size_t i = 0; i < _shards.size(); i++ ) {
+		_shards[i]->now = monotonic_ms() / 1000;
+		_shards[i]->timers.start(_shards[i]->now);
+		_shards[i]->poller = Poller::create(_poller_name);
+		_shards[i]->poller->addListener(_shards[i]->sockfd);
+		_shards[i]->poller->add(_shards[i]->wake[0], POLLER_IN);
+	}
+	cout << YELLOW << "Using " << _shards[0]->poller->getName() << " backend, "
+		 << _shards.size() << " shard(s), " << scan_name() << " scanning" << RESET << endl;
+
+	// Shard 0 runs on the main thread
+	_shards[0]->thread = pthread_self();
+	for ( size_t i = 1; i < _shards.size(); i++ )
+		if ( pthread_create(&_shards[i]->thread, NULL, Server::shardMain, _shards[i]) )
+			throw eExc("pthread_create: failed to start shard");
+	this->runShard(*_shards[0]);
 }
 
 bool					Server::username_isIRCOper( string usr_name )
@@ -379,13 +853,9 @@ bool					Server::isIRCOperator( string usr_name, string pswd )
 	return false;
 }
 
-Channel *				Server::getChannelByName( string channel ) {
+Channel *				Server::getChannelByName( string const & channel ) const {
 
-	for (vector<Channel*>::iterator it = _channels.begin(); it != _channels.end(); ++it) {
-		if ( (*it)->getName() == channel )
-			return *it;
-	}
-	return NULL;
+	return _chan_index.find(channel);
 }
 
 Channel *				Server::getChannelByKey( string key ) {
@@ -397,46 +867,88 @@ Channel *				Server::getChannelByKey( string key ) {
 	return NULL;
 }
 
-User *				Server::getUserByNick( string nick ) {
+User *				Server::getUserByNick( string const & nick ) const {
 
-	for (vector<User*>::iterator it = _users.begin(); it != _users.end(); ++it) {
-		User * usr = *it;
-		if ( usr->getNick() == nick )
-			return usr;
-	}
-	return NULL;
+	return _nicks.find(nick);
+}
+
+// The only way to change a nick, so the index stays in sync
+void				Server::setUserNick( User & u, string const & nick ) {
+
+	if ( _nicks.find(u.getNick()) == &u )
+		_nicks.erase(u.getNick());
+	u.setNick(nick);
+	_nicks.insert(nick, &u);
 }
 
+// Channels live in the pool, deleteChannel() gives them back
+Channel *			Server::newChannel( string const & name, string const & key, User * creator ) {
+
+	Channel *	channel = new (_chan_pool.alloc()) Channel(name, key, "", creator, "nt");
+
+	addChannel(channel);
+	return channel;
+}
+
+// Ids are never reused, the slot only lets deleteChannel() swap it out
 void				Server::addChannel( Channel * channel ) {
 	
+	channel->setId(_next_chan_id++);
+	channel->setSlot(_channels.size());
 	_channels.push_back(channel);
+	_chan_index.insert(channel->getName(), channel);
 }
 
 void				Server::deleteChannel( Channel * channel ) {
 
-	for ( vector<Channel*>::iterator it = _channels.begin(); it != _channels.end(); it++ ) {
-		if ( (*it)->getName() == channel->getName() ) {
-			delete *it;
-			_channels.erase(it);
-			return ;
-		}
-	}
+	size_t		slot = channel->getSlot();
+
+	if ( slot >= _channels.size() || _channels[slot] != channel )
+		return ;
+	_chan_index.erase(channel->getName());
+	_channels[slot] = _channels.back();
+	_channels[slot]->setSlot(slot);
+	_channels.pop_back();
+	_chan_pool.release(channel);
 }
 
+// Swapped out through its slot like channels, the list order doesn't matter
 void				Server::deleteUser( User * u ) {
 
-	int i = 0;
+	size_t		slot = u->getSlot();
 
-	for ( vector<User*>::iterator it = _users.begin(); it != _users.end(); ++it ) {
-		if ( (*it)->getNick() == u->getNick() ) {
-			_usr_buf[i] = "";
-			delete *it;
-			_users.erase(it);
-			_usr_buf[i] = _usr_buf[_users.size() - 1];
-			return ;
-		}
-		i++;
+	if ( slot >= _users.size() || _users[slot] != u )
+		return ;
+	if ( _nicks.find(u->getNick()) == u )
+		_nicks.erase(u->getNick());
+	_users[slot] = _users.back();
+	_users[slot]->setSlot(slot);
+	_users.pop_back();
+	_user_pool.release(u);
+}
+
+// Drops a client for good: members of its channels get a QUIT, then
+// whatever is still queued for it gets a last chance to go out.
+// Must run on the shard owning the connection.
+void				Server::disconnect( User & u, string const & reason ) {
+
+	int					fd = u.getFd();
+
+	for (Membership *m = u.getChannels(); m; m = m->user_next)
+		send_notice_channel(u, m->chan, NTC_QUIT(reason));
+
+	while ( u.getChannels() ) {
+		Channel *	c = u.getChannels()->chan;
+
+		c->deleteMember(&u);
+		if ( !c->getNbMembers() )
+			deleteChannel(c);
 	}
 
-	
-}
\ No newline at end of file
+	u.getSendQ().flush(fd);
+	u.getShard()->timers.cancel(&u.getTimer());
+	del_from_pfds(*u.getShard(), fd);
+	deleteUser(&u);
+
+	cout << BOLDWHITE << "❌ Client #" << fd << " gone away (" << reason << ")" << RESET << endl;
+}
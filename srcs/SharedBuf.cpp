@@ -0,0 +1,121 @@
+#include "headers.hpp"
+
+Pool<IoChunk>		g_out_chunks;
+Pool<IoLine>		g_out_lines;
+
+# define SHAREDBUF_HDR		offsetof(Data, bytes)
+
+SharedBuf::SharedBuf( void ) : _d(NULL)
+{
+}
+
+SharedBuf::SharedBuf( string const & s )
+{
+	init(s.data(), s.size(), s.size());
+}
+
+SharedBuf::SharedBuf( char const * p, size_t n )
+{
+	init(p, n, n);
+}
+
+SharedBuf::SharedBuf( size_t cap )
+{
+	init(NULL, 0, cap);
+}
+
+SharedBuf::SharedBuf( SharedBuf const &src ) : _d(src._d)
+{
+	if (_d)
+		_d->refs++;
+}
+
+SharedBuf::~SharedBuf( void )
+{
+	release();
+}
+
+SharedBuf			&SharedBuf::operator=( SharedBuf const &rhs )
+{
+	if (rhs._d)
+		rhs._d->refs++;
+	release();
+	_d = rhs._d;
+
+	return (*this);
+}
+
+void				SharedBuf::init( char const * p, size_t n, size_t cap )
+{
+	if (SHAREDBUF_HDR + cap <= sizeof(IoLine)) {
+		_d = static_cast<Data *>(g_out_lines.alloc());
+		cap = sizeof(IoLine) - SHAREDBUF_HDR;
+	}
+	else if (SHAREDBUF_HDR + cap <= sizeof(IoChunk)) {
+		_d = static_cast<Data *>(g_out_chunks.alloc());
+		cap = chunkRoom();
+	}
+	else
+		_d = static_cast<Data *>(::operator new(SHAREDBUF_HDR + cap));
+	_d->refs = 1;
+	_d->len = n;
+	_d->cap = cap;
+	if (n)
+		memcpy(_d->bytes, p, n);
+}
+
+void				SharedBuf::release( void )
+{
+	if (_d && --_d->refs == 0) {
+		// The capacity tells where it came from
+		if (_d->cap == sizeof(IoLine) - SHAREDBUF_HDR)
+			g_out_lines.release(reinterpret_cast<IoLine *>(_d));
+		else if (_d->cap == chunkRoom())
+			g_out_chunks.release(reinterpret_cast<IoChunk *>(_d));
+		else
+			::operator delete(_d);
+	}
+	_d = NULL;
+}
+
+/*								GETTERS										*/
+
+char const *		SharedBuf::data( void ) const
+{
+	return _d ? _d->bytes : "";
+}
+
+size_t				SharedBuf::size( void ) const
+{
+	return _d ? _d->len : 0;
+}
+
+size_t				SharedBuf::room( void ) const
+{
+	return _d ? _d->cap - _d->len : 0;
+}
+
+bool				SharedBuf::unique( void ) const
+{
+	return _d && _d->refs == 1;
+}
+
+// Payload of a pooled chunk, what SendQ asks for to pile replies up
+size_t				SharedBuf::chunkRoom( void )
+{
+	return sizeof(IoChunk) - SHAREDBUF_HDR;
+}
+
+/*								MEMBERS FUNCTIONS							*/
+
+// Free space after the data; write at most room() bytes then grow() by them.
+// Only for unique() buffers, shared ones are immutable.
+char *				SharedBuf::tail( void )
+{
+	return _d->bytes + _d->len;
+}
+
+void				SharedBuf::grow( size_t n )
+{
+	_d->len += n;
+}
@@ -0,0 +1,139 @@
+#include "headers.hpp"
+
+TimerWheel::TimerWheel( void ) : _now(0), _size(0)
+{
+	memset(_slots, 0, sizeof _slots);
+}
+
+TimerWheel::~TimerWheel( void )
+{
+}
+
+/*								GETTERS										*/
+
+size_t				TimerWheel::size( void ) const
+{
+	return _size;
+}
+
+// Milliseconds the event loop may sleep: up to the next non-empty slot of
+// the first level, or the next cascade. -1 with nothing scheduled.
+int					TimerWheel::timeout( uint64_t now_ms ) const
+{
+	if (!_size)
+		return -1;
+
+	uint64_t	tick = _now + 1;
+
+	while ((tick & (WHEEL_SLOTS - 1)) && !_slots[tick & (WHEEL_SLOTS - 1)])
+		tick++;
+
+	uint64_t	at = tick * 1000;
+
+	return at > now_ms ? (int)(at - now_ms) : 0;
+}
+
+/*								MEMBERS FUNCTIONS							*/
+
+void				TimerWheel::start( uint64_t now )
+{
+	_now = now;
+}
+
+// The level is chosen by how far the deadline is, the slot by its tick
+void				TimerWheel::place( Timer * t )
+{
+	uint64_t	delta = t->expires - _now;
+	int			level = 0;
+
+	while (level < WHEEL_LEVELS - 1 && delta >= (uint64_t)1 << (WHEEL_BITS * (level + 1)))
+		level++;
+
+	int			slot = level * WHEEL_SLOTS
+		+ ((t->expires >> (WHEEL_BITS * level)) & (WHEEL_SLOTS - 1));
+
+	t->slot = slot;
+	t->prev = NULL;
+	t->next = _slots[slot];
+	if (t->next)
+		t->next->prev = t;
+	_slots[slot] = t;
+}
+
+void				TimerWheel::schedule( Timer * t, uint64_t expires )
+{
+	uint64_t	max = ((uint64_t)1 << (WHEEL_BITS * WHEEL_LEVELS)) - 1;
+
+	if (t->slot != -1) {
+		if (t->expires == expires)
+			return ;
+		cancel(t);
+	}
+	// A deadline in the past fires on the next tick
+	if (expires <= _now)
+		expires = _now + 1;
+	if (expires - _now > max)
+		expires = _now + max;
+	t->expires = expires;
+	place(t);
+	_size++;
+}
+
+void				TimerWheel::cancel( Timer * t )
+{
+	if (t->slot == -1)
+		return ;
+	if (t->prev)
+		t->prev->next = t->next;
+	else
+		_slots[t->slot] = t->next;
+	if (t->next)
+		t->next->prev = t->prev;
+	t->slot = -1;
+	_size--;
+}
+
+// Timers of the current slot of an upper level are close enough now
+void				TimerWheel::cascade( int level )
+{
+	int		slot = level * WHEEL_SLOTS
+		+ ((_now >> (WHEEL_BITS * level)) & (WHEEL_SLOTS - 1));
+	Timer *	t = _slots[slot];
+
+	_slots[slot] = NULL;
+	while (t) {
+		Timer *	next = t->next;
+
+		place(t);
+		t = next;
+	}
+}
+
+// Fires every tick up to now, handing back the connections whose timer
+// expired. Their nodes are unlinked, ready to be scheduled again.
+void				TimerWheel::advance( uint64_t now, vector<ConnRef> & expired )
+{
+	if (!_size && now > _now)
+		_now = now;
+	while (_now < now) {
+		_now++;
+		for (int level = 1; level < WHEEL_LEVELS; level++) {
+			if (_now & (((uint64_t)1 << (WHEEL_BITS * level)) - 1))
+				break ;
+			cascade(level);
+		}
+
+		int		slot = _now & (WHEEL_SLOTS - 1);
+		Timer *	t = _slots[slot];
+
+		_slots[slot] = NULL;
+		while (t) {
+			Timer *	next = t->next;
+
+			t->slot = -1;
+			_size--;
+			expired.push_back(t->ref);
+			t = next;
+		}
+	}
+}
@@ -0,0 +1,389 @@
+#include "headers.hpp"
+
+#ifdef HAS_IO_URING
+
+# define URING_ENTRIES		1024
+# define URING_BATCH		(URING_ENTRIES / 2)	// Requests in flight, far from the CQ size
+
+// user_data: the kind of request in the top two bits, then for a POLL_ADD
+// its generation and fd, for a RECV or SENDMSG its index in _ops
+# define URING_POLL			(0ULL << 62)
+# define URING_OP			(1ULL << 62)
+# define URING_ACCEPT		(2ULL << 62)
+# define URING_REMOVE		(3ULL << 62)
+# define URING_KIND			(3ULL << 62)
+# define URING_GEN_MASK		0x3FFFFFFFU
+
+static uint64_t			poll_tag( int fd, uint32_t gen )
+{
+	return URING_POLL | ((uint64_t)(gen & URING_GEN_MASK) << 32) | (uint32_t)fd;
+}
+
+/*								CONSTRUCTORS								*/
+
+UringPoller::UringPoller( void ) :
+		_ring_fd(-1),
+		_ring(MAP_FAILED),
+		_ring_sz(0),
+		_sqes((struct io_uring_sqe *)MAP_FAILED),
+		_sqes_sz(0),
+		_sq_pending(0),
+		_gen(),
+		_interest(),
+		_slot(),
+		_ready(),
+		_ops(),
+		_ops_left(0),
+		_listener(-1)
+{
+	struct io_uring_params	p;
+
+	memset(&p, 0, sizeof p);
+	_ring_fd = syscall(__NR_io_uring_setup, URING_ENTRIES, &p);
+	if (_ring_fd == -1)
+		throw eExc(strerror(errno));
+
+	// Single mmap for both rings and timeouts passed to io_uring_enter()
+	if (!(p.features & IORING_FEAT_SINGLE_MMAP) || !(p.features & IORING_FEAT_EXT_ARG)) {
+		close(_ring_fd);
+		throw eExc("io_uring: kernel too old");
+	}
+
+	_ring_sz = max(p.sq_off.array + p.sq_entries * sizeof(unsigned),
+				p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe));
+	_ring = mmap(NULL, _ring_sz, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+				_ring_fd, IORING_OFF_SQ_RING);
+	_sqes_sz = p.sq_entries * sizeof(struct io_uring_sqe);
+	_sqes = (struct io_uring_sqe *)mmap(NULL, _sqes_sz, PROT_READ | PROT_WRITE,
+				MAP_SHARED | MAP_POPULATE, _ring_fd, IORING_OFF_SQES);
+	if (_ring == MAP_FAILED || _sqes == MAP_FAILED) {
+		int	e = errno;
+
+		if (_ring != MAP_FAILED)
+			munmap(_ring, _ring_sz);
+		close(_ring_fd);
+		throw eExc(strerror(e));
+	}
+
+	char *	r = (char *)_ring;
+
+	_sq_head = (unsigned *)(r + p.sq_off.head);
+	_sq_tail = (unsigned *)(r + p.sq_off.tail);
+	_sq_array = (unsigned *)(r + p.sq_off.array);
+	_sq_mask = *(unsigned *)(r + p.sq_off.ring_mask);
+	_sq_entries = *(unsigned *)(r + p.sq_off.ring_entries);
+	_cq_head = (unsigned *)(r + p.cq_off.head);
+	_cq_tail = (unsigned *)(r + p.cq_off.tail);
+	_cq_mask = *(unsigned *)(r + p.cq_off.ring_mask);
+	_cqes = (struct io_uring_cqe *)(r + p.cq_off.cqes);
+}
+
+UringPoller::~UringPoller( void )
+{
+	munmap(_sqes, _sqes_sz);
+	munmap(_ring, _ring_sz);
+	close(_ring_fd);
+}
+
+/*								GETTERS										*/
+
+char const *			UringPoller::getName( void ) const
+{
+	return "io_uring";
+}
+
+bool					UringPoller::isEdgeTriggered( void ) const
+{
+	return true;
+}
+
+/*								RING UTILS									*/
+
+// Reserves the next SQE. It's only published to the kernel by enter().
+struct io_uring_sqe *	UringPoller::getSqe( void )
+{
+	unsigned	head = __atomic_load_n(_sq_head, __ATOMIC_ACQUIRE);
+	unsigned	tail = *_sq_tail + _sq_pending;
+
+	if (tail - head >= _sq_entries) {
+		enter(0, 0);
+		head = __atomic_load_n(_sq_head, __ATOMIC_ACQUIRE);
+		tail = *_sq_tail;
+		if (tail - head >= _sq_entries)
+			throw eExc("io_uring: submission queue full");
+	}
+
+	unsigned				idx = tail & _sq_mask;
+	struct io_uring_sqe *	sqe = &_sqes[idx];
+
+	memset(sqe, 0, sizeof *sqe);
+	_sq_array[idx] = idx;
+	_sq_pending++;
+	return sqe;
+}
+
+// Publishes the reserved SQEs and submits them, waiting for min_complete
+// completions (timeout in ms, -1 for none) in the same syscall.
+int						UringPoller::enter( unsigned min_complete, int timeout )
+{
+	struct io_uring_getevents_arg	arg;
+	struct __kernel_timespec		ts;
+	unsigned						flags = 0;
+	void *							argp = NULL;
+	size_t							argsz = 0;
+
+	if (_sq_pending) {
+		__atomic_store_n(_sq_tail, *_sq_tail + _sq_pending, __ATOMIC_RELEASE);
+		_sq_pending = 0;
+	}
+
+	unsigned	to_submit = *_sq_tail - __atomic_load_n(_sq_head, __ATOMIC_ACQUIRE);
+
+	if (min_complete) {
+		flags |= IORING_ENTER_GETEVENTS;
+		if (timeout >= 0) {
+			ts.tv_sec = timeout / 1000;
+			ts.tv_nsec = (timeout % 1000) * 1000000L;
+			memset(&arg, 0, sizeof arg);
+			arg.ts = (uint64_t)(uintptr_t)&ts;
+			flags |= IORING_ENTER_EXT_ARG;
+			argp = &arg;
+			argsz = sizeof arg;
+		}
+	}
+	if (!to_submit && !min_complete)
+		return 0;
+
+	int		ret = syscall(__NR_io_uring_enter, _ring_fd, to_submit, min_complete,
+						flags, argp, argsz);
+
+	if (ret == -1) {
+		if (errno == ETIME || errno == EINTR || errno == EBUSY || errno == EAGAIN)
+			return 0;
+		throw eExc(strerror(errno));
+	}
+	return ret;
+}
+
+void					UringPoller::arm( int fd )
+{
+	struct io_uring_sqe *	sqe = getSqe();
+	unsigned				ev = 0;
+
+	if (_interest[fd] & POLLER_IN)
+		ev |= POLLIN;
+	if (_interest[fd] & POLLER_OUT)
+		ev |= POLLOUT;
+	_gen[fd]++;
+	sqe->opcode = IORING_OP_POLL_ADD;
+	sqe->fd = fd;
+	sqe->poll32_events = ev;
+	sqe->len = IORING_POLL_ADD_MULTI;
+	sqe->user_data = poll_tag(fd, _gen[fd]);
+}
+
+void					UringPoller::disarm( int fd )
+{
+	struct io_uring_sqe *	sqe = getSqe();
+
+	sqe->opcode = IORING_OP_POLL_REMOVE;
+	sqe->fd = -1;
+	sqe->addr = poll_tag(fd, _gen[fd]);
+	sqe->user_data = URING_REMOVE;
+	_gen[fd]++;
+}
+
+// One request accepts connections until it fails, each one a completion
+void					UringPoller::armAccept( void )
+{
+	struct io_uring_sqe *	sqe = getSqe();
+
+	sqe->opcode = IORING_OP_ACCEPT;
+	sqe->fd = _listener;
+	sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+	sqe->user_data = URING_ACCEPT;
+}
+
+// Several completions for one fd are merged into a single event
+void					UringPoller::readiness( int fd, int events )
+{
+	if ((size_t)fd >= _slot.size())
+		_slot.resize(fd + 1, -1);
+	if (_slot[fd] == -1) {
+		PollerEvent	e;
+
+		e.fd = fd;
+		e.events = events;
+		_slot[fd] = _ready.size();
+		_ready.push_back(e);
+	}
+	else
+		_ready[_slot[fd]].events |= events;
+}
+
+// Takes every completion in the queue: results go to the requests' owners,
+// readiness and accepted connections to _ready
+void					UringPoller::reap( void )
+{
+	unsigned	head = *_cq_head;
+	unsigned	tail = __atomic_load_n(_cq_tail, __ATOMIC_ACQUIRE);
+
+	for (; head != tail; head++) {
+		struct io_uring_cqe *	cqe = &_cqes[head & _cq_mask];
+		uint64_t				kind = cqe->user_data & URING_KIND;
+
+		if (kind == URING_OP) {
+			*_ops[cqe->user_data & ~URING_KIND] = cqe->res;
+			_ops_left--;
+			continue ;
+		}
+		if (kind == URING_ACCEPT) {
+			if (!(cqe->flags & IORING_CQE_F_MORE) && _listener != -1) {
+				// Kernel without multishot ACCEPT: poll the listener instead
+				if (cqe->res == -EINVAL) {
+					int	fd = _listener;
+
+					_listener = -1;
+					add(fd, POLLER_IN);
+					continue ;
+				}
+				armAccept();
+			}
+			if (cqe->res >= 0)
+				readiness(cqe->res, POLLER_ACCEPT);
+			else if (cqe->res != -EAGAIN && cqe->res != -ECONNABORTED && cqe->res != -EINTR)
+				throw eExc(strerror(-cqe->res));
+			continue ;
+		}
+		if (kind == URING_REMOVE)
+			continue ;
+
+		int			fd = (int)(cqe->user_data & 0xFFFFFFFF);
+		uint32_t	gen = (uint32_t)(cqe->user_data >> 32) & URING_GEN_MASK;
+
+		if ((size_t)fd >= _gen.size() || gen != (_gen[fd] & URING_GEN_MASK) || !_interest[fd])
+			continue ;
+		// Multishot request ended (overflow, error): watch the fd again
+		if (!(cqe->flags & IORING_CQE_F_MORE))
+			arm(fd);
+		if (cqe->res <= 0)
+			continue ;
+
+		int		events = 0;
+
+		if (cqe->res & POLLIN)
+			events |= POLLER_IN;
+		if (cqe->res & POLLOUT)
+			events |= POLLER_OUT;
+		if (cqe->res & (POLLERR | POLLHUP))
+			events |= POLLER_ERR;
+		readiness(fd, events);
+	}
+	__atomic_store_n(_cq_head, head, __ATOMIC_RELEASE);
+}
+
+/*								MEMBERS FUNCTIONS							*/
+
+void					UringPoller::add( int fd, int events )
+{
+	if ((size_t)fd >= _interest.size()) {
+		_gen.resize(fd + 1, 0);
+		_interest.resize(fd + 1, 0);
+		_slot.resize(fd + 1, -1);
+	}
+	_interest[fd] = events;
+	arm(fd);
+}
+
+void					UringPoller::modify( int fd, int events )
+{
+	if ((size_t)fd >= _interest.size() || !_interest[fd] || _interest[fd] == events)
+		return ;
+	disarm(fd);
+	_interest[fd] = events;
+	arm(fd);
+}
+
+void					UringPoller::remove( int fd )
+{
+	if ((size_t)fd >= _interest.size() || !_interest[fd])
+		return ;
+	disarm(fd);
+	_interest[fd] = 0;
+	// The poll request holds a file reference: submit now so close() really closes
+	enter(0, 0);
+}
+
+int						UringPoller::wait( vector<PollerEvent> & ready, int timeout )
+{
+	ready.clear();
+
+	// Submits what add() and modify() queued, sleeps only if nothing is in
+	if (_ready.empty() && *_cq_head == __atomic_load_n(_cq_tail, __ATOMIC_ACQUIRE))
+		enter(1, timeout);
+	else
+		enter(0, 0);
+	reap();
+	ready.swap(_ready);
+	for (size_t i = 0; i < ready.size(); i++)
+		_slot[ready[i].fd] = -1;
+	return ready.size();
+}
+
+/*								I/O BATCH									*/
+
+void					UringPoller::addListener( int fd )
+{
+	_listener = fd;
+	armAccept();
+}
+
+// MSG_DONTWAIT: a socket with nothing to give or no room completes with
+// -EAGAIN right away instead of waiting in the kernel
+void					UringPoller::queueRecv( int fd, char * buf, size_t len, ssize_t * res )
+{
+	if (_ops_left >= URING_BATCH)
+		submit();
+
+	struct io_uring_sqe *	sqe = getSqe();
+
+	sqe->opcode = IORING_OP_RECV;
+	sqe->fd = fd;
+	sqe->addr = (uint64_t)(uintptr_t)buf;
+	sqe->len = len;
+	sqe->msg_flags = MSG_DONTWAIT;
+	sqe->user_data = URING_OP | _ops.size();
+	_ops.push_back(res);
+	_ops_left++;
+}
+
+void					UringPoller::queueSend( int fd, struct msghdr * msg, int flags, ssize_t * res )
+{
+	if (_ops_left >= URING_BATCH)
+		submit();
+
+	struct io_uring_sqe *	sqe = getSqe();
+
+	sqe->opcode = IORING_OP_SENDMSG;
+	sqe->fd = fd;
+	sqe->addr = (uint64_t)(uintptr_t)msg;
+	sqe->len = 1;
+	sqe->msg_flags = flags | MSG_DONTWAIT;
+	sqe->user_data = URING_OP | _ops.size();
+	_ops.push_back(res);
+	_ops_left++;
+}
+
+// One io_uring_enter() submits the batch. Requests on sockets that can't
+// proceed fail with -EAGAIN, so the whole batch has usually completed by
+// the time it returns; if not, wait for the rest.
+void					UringPoller::submit( void )
+{
+	while (_ops_left) {
+		enter(1, -1);
+		reap();
+	}
+	_ops.clear();
+}
+
+#endif
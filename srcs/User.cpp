@@ -1,55 +1,107 @@
 #include "headers.hpp"
 
-User::User( void ) : _fd(-1), _nick(""), _username(""), _hostname(""),
-			_servername(""), _realname(""), _mode(""), _passwd(""), 
-			_ping_status(false), _isset(false), _isIRCOper(false), _isAuth(false),
-			_curr_chan(NULL), _channels()
+// Every user's details, output queue and timer are in the same few slabs,
+// under the server lock
+static Pool<UserInfo>	g_user_info;
+static Pool<SendQ>		g_sendqs;
+static Pool<Timer>		g_timers;
+static string const		g_none;
+
+User::User( void ) : _fd(-1), _ping_status(false), _isset(false), _isIRCOper(false),
+	_isAuth(false), _lagged(false), _shard(NULL), _sendq(NULL), _modes(),
+	_chans(NULL), _chans_tail(NULL), _nb_chans(0), _curr_chan(NULL), _ident_gen(1),
+	_tokens(FLOOD_BURST), _refilled(0), _timer(NULL), _slot(0), _info(NULL)
 {
+	init();
+	_nick[0] = '\0';
+	updateFci();
 }
 
-User::User( int fd ) : _fd(fd), _nick(""), _username(""), _hostname(""),
-	_servername(""), _realname(""), _mode(""), _passwd(""), _ping_status(false),
-	_isset(false),  _isIRCOper(false), _isAuth(false), _curr_chan(NULL), _channels()
+User::User( int fd ) : _fd(fd), _ping_status(false), _isset(false), _isIRCOper(false),
+	_isAuth(false), _lagged(false), _shard(NULL), _sendq(NULL), _modes(),
+	_chans(NULL), _chans_tail(NULL), _nb_chans(0), _curr_chan(NULL), _ident_gen(1),
+	_tokens(FLOOD_BURST), _refilled(0), _timer(NULL), _slot(0), _info(NULL)
 {
+	init();
+	_nick[0] = '\0';
+	updateFci();
 }
 
 User::User( int fd, string nick, string username, string hostname,
 	string servername, string realname, string mode, bool ping_status ) :
-	_fd(fd), _nick(nick), _username(username), _hostname(hostname), _servername(servername),
-	_realname(realname), _mode(mode), _ping_status(ping_status), _isset(false),
-	_isIRCOper(false), _isAuth(false), _curr_chan(NULL), _channels()
+	_fd(fd), _ping_status(ping_status), _isset(false), _isIRCOper(false),
+	_isAuth(false), _lagged(false), _shard(NULL), _sendq(NULL), _modes(mode),
+	_chans(NULL), _chans_tail(NULL), _nb_chans(0), _curr_chan(NULL), _ident_gen(1),
+	_tokens(FLOOD_BURST), _refilled(0), _timer(NULL), _slot(0), _info(NULL)
 {
+	init();
+	_nick[nick.copy(_nick, MAX_USR_NICK_LEN)] = '\0';
+	info().username = username;
+	info().hostname = hostname;
+	info().servername = servername;
+	info().realname = realname;
+	updateFci();
 }
 
-User::User( User const &src )
+User::User( User const &src ) : _sendq(NULL), _timer(NULL), _info(NULL)
 {
+	init();
 	*this = src;
 }
 
 User::~User( void )
 {
+	g_sendqs.release(_sendq);
+	g_timers.release(_timer);
+	if (_info)
+		g_user_info.release(_info);
 }
 
 User				&User::operator=( User const &rhs )
 {
+	if (this == &rhs)
+		return (*this);
 	_fd = rhs._fd;
-	_nick = rhs._nick;
-	_username = rhs._username;
-	_hostname = rhs._hostname;
-	_servername = rhs._servername;
-	_realname = rhs._realname;
-	_mode = rhs._mode;
-	_passwd = rhs._passwd;
-	_last_act = rhs._last_act;
 	_ping_status = rhs._ping_status;
 	_isset = rhs._isset;
 	_isIRCOper = rhs._isIRCOper;
+	_isAuth = rhs._isAuth;
+	_lagged = false;
+	_shard = rhs._shard;
+	*_sendq = *rhs._sendq;
+	_modes = rhs._modes;
+	_prefix = rhs._prefix;
+	memcpy(_nick, rhs._nick, sizeof(_nick));
+	// Memberships stay with the original
+	_chans = NULL;
+	_chans_tail = NULL;
+	_nb_chans = 0;
 	_curr_chan = rhs._curr_chan;
-	_channels = rhs._channels;
+	_ident_gen = rhs._ident_gen;
+	_tokens = rhs._tokens;
+	_refilled = rhs._refilled;
+	_timer->slot = -1;
+	_last_act = rhs._last_act;
+	_slot = rhs._slot;
+	if (rhs._info)
+		info() = *rhs._info;
+	else if (_info) {
+		g_user_info.release(_info);
+		_info = NULL;
+	}
 
 	return (*this);
 }
 
+// Takes the output queue and the timer out of their pools
+void				User::init( void )
+{
+	_sendq = new (g_sendqs.alloc()) SendQ();
+	_timer = new (g_timers.alloc()) Timer();
+	_timer->slot = -1;
+	_last_act = time(0);
+}
+
 /*								GETTERS										*/
 
 int	const				&User::getFd( void ) const
@@ -57,46 +109,71 @@ int	const				&User::getFd( void ) const
 	return _fd;
 }
 
-string const			&User::getNick( void ) const
+Shard					*User::getShard( void ) const
+{
+	return _shard;
+}
+
+SendQ					&User::getSendQ( void )
+{
+	return *_sendq;
+}
+
+char const				*User::getNick( void ) const
 {
 	return _nick;
 }
 
 string const			&User::getUsername( void ) const
 {
-	return _username;
+	return _info ? _info->username : g_none;
 }
 
 string const			&User::getHostname( void ) const
 {
-	return _hostname;
+	return _info ? _info->hostname : g_none;
 }
 
 string const			&User::getServername( void ) const
 {
-	return _servername;
+	return _info ? _info->servername : g_none;
 }
 
 string const			&User::getRealName( void ) const
 {
-	return _realname;
+	return _info ? _info->realname : g_none;
 }
 
 string const			&User::getMode( void ) const
 {
-	return _mode;
+	return _modes.str();
 }
 
 string const			&User::getPasswd( void ) const
 {
-	return _passwd;
+	return _info ? _info->passwd : g_none;
 }
 
-time_t 					*User::getLastAct( void ) const
+time_t					User::getLastAct( void ) const
 {
 	return _last_act;
 }
 
+Timer					&User::getTimer( void )
+{
+	return *_timer;
+}
+
+int						User::getTokens( void ) const
+{
+	return _tokens;
+}
+
+bool					User::isLagged( void ) const
+{
+	return _lagged;
+}
+
 bool const				&User::getPingStatus( void ) const
 {
 	return _ping_status;
@@ -112,11 +189,6 @@ bool const				&User::getIsAuth( void ) const
 	return _isAuth;
 }
 
-vector<Channel*>		User::getChans( void ) const
-{
-	return _channels;
-}
-
 bool const				&User::getIsIRCOper( void ) const
 {
 	return _isIRCOper;
@@ -127,9 +199,32 @@ Channel					*User::getCurrChan( void ) const
 	return _curr_chan;
 }
 
-vector<Channel*> const	&User::getChannels( void ) const
+Membership				*User::getChannels( void ) const
+{
+	return _chans;
+}
+
+size_t					User::getNbChannels( void ) const
+{
+	return _nb_chans;
+}
+
+Membership				*User::getMembership( Channel const &c ) const
 {
-	return _channels;
+	for (Membership *m = _chans; m; m = m->user_next)
+		if (m->chan == &c)
+			return m;
+	return NULL;
+}
+
+unsigned				User::getIdentGen( void ) const
+{
+	return _ident_gen;
+}
+
+size_t					User::getSlot( void ) const
+{
+	return _slot;
 }
 
 /*								SETTERS										*/
@@ -139,44 +234,56 @@ void					User::setFd( int fd )
 	_fd = fd;
 }
 
+void					User::setShard( Shard *shard )
+{
+	_shard = shard;
+}
+
+// NICK checked the length, longer ones are cut
 void					User::setNick( string nick )
 {
-	_nick = nick;
+	_nick[nick.copy(_nick, MAX_USR_NICK_LEN)] = '\0';
+	_ident_gen++;
+	updateFci();
 }
 
 void 					User::setUsername( string username )
 {
-	_username = username;
+	info().username = username;
+	_ident_gen++;
+	updateFci();
 }
 
 void					User::setHostname( string hostname )
 {
-	_hostname = hostname;
+	info().hostname = hostname;
+	_ident_gen++;
+	updateFci();
 }
 
 void					User::setServername( string servername )
 {
-	_servername = servername;
+	info().servername = servername;
 }
 
 void					User::setRealName( string realname )
 {
-	_realname = realname;
+	info().realname = realname;
 }
 
 void					User::setMode( string mode )
 {
-	_mode = mode;
+	_modes = ModeSet(mode);
 }
 
 void					User::setPasswd( string passwd )
 {
-	_passwd = passwd;
+	info().passwd = passwd;
 }
 
 void					User::setLastAct( time_t last_act )
 {
-	_last_act = &last_act;
+	_last_act = last_act;
 }
 
 void					User::setPingStatus( bool ping_status )
@@ -184,6 +291,11 @@ void					User::setPingStatus( bool ping_status )
 	_ping_status = ping_status;
 }
 
+void					User::setLagged( bool lagged )
+{
+	_lagged = lagged;
+}
+
 void					User::setIsSet( bool isset )
 {
 	_isset = isset;
@@ -213,11 +325,16 @@ void					User::setCurrChan( Channel *c )
 		cout << MAGENTA << getNick() << " isnt on any channel" << RESET << endl;
 }
 
+void					User::setSlot( size_t slot )
+{
+	_slot = slot;
+}
+
 /*								MEMBERS FUNCTIONS							*/
 
 bool				User::isRegistered( void ) const
 {
-	if (!getNick().empty() && getIsSet())
+	if (_nick[0] && getIsSet())
 		return true;
 	
 	return false;
@@ -230,8 +347,8 @@ bool				User::isIRCOper( void ) const
 
 bool				User::isChanOper( void ) const
 {
-	for (vector<Channel*>::const_iterator it = _channels.begin(); it != _channels.end(); ++it)
-		if ((*it)->isOper(*this))
+	for (Membership *m = _chans; m; m = m->user_next)
+		if (m->flags & MEMBER_OP)
 			return true;
 	
 	return false;
@@ -239,13 +356,36 @@ bool				User::isChanOper( void ) const
 
 bool 				User::isVisible( void ) const
 {
-	return _mode.find('i') == string::npos;
+	return !_modes.has('i');
+}
+
+// Full-Client Identifier (FCI): <nick>!<user>@<host>
+string const		&User::fci( void ) const
+{
+	return _info ? _info->fci : g_none;
+}
+
+// What every line relayed from this user starts with
+string const		&User::getPrefix( void ) const
+{
+	return _prefix;
+}
+
+// Rebuilt on NICK and USER only, the fan-out path just copies the bytes
+void				User::updateFci( void )
+{
+	string &		fci = info().fci;
+
+	fci = _nick;
+	fci += "!" + getUsername() + "@" + getHostname();
+	_prefix = ":" + fci + " ";
 }
 
-string const		User::fci( void ) const
+UserInfo			&User::info( void )
 {
-	// Returns Full-Client Identifier (FCI): <nick>!<user>@<host>
-	return _nick + "!" + _username + "@" + _hostname;
+	if (!_info)
+		_info = new (g_user_info.alloc()) UserInfo();
+	return *_info;
 }
 
 string				User::addMode( string mode )
@@ -253,14 +393,12 @@ string				User::addMode( string mode )
 	string	to_add = "";
 
 	for (size_t i = 0; i < mode.size(); i++) {
-		if (( _mode.find(mode[i]) == string::npos) && mode[i] != 'o')
-			to_add += mode[i];
-		else if (mode[i] == 'o' && isIRCOper()) // IRC operator
+		if (mode[i] == 'o' && !isIRCOper()) // IRC operator
+			continue ;
+		if (_modes.add(mode[i]))
 			to_add += mode[i];
 	}
 
-	_mode += to_add;
-
 	return (to_add);
 }
 
@@ -268,71 +406,77 @@ string				User::rmMode( string mode )
 {
 	string	removed = "";
 
-	for (size_t i = 0; i < mode.size(); i++) {
-		size_t to_remove = _mode.find(mode[i]);
-		if ( to_remove != string::npos )
-		{
-			_mode.erase(_mode.begin() + to_remove);
+	for (size_t i = 0; i < mode.size(); i++)
+		if (_modes.remove(mode[i]))
 			removed += mode[i];
-		}
-	}
 
 	return (removed);
 }
 
-void				User::addChannel( Channel * channel ) {
-	
-	if (_channels.size() < MAX_CHAN_PER_USR)
-	{
-		cout << MAGENTA << this->getNick() << " joined channel " << channel->getName() << RESET << endl;
-		_channels.push_back(channel);
-	}
+// Only Channel::addMember() and Channel::deleteMember() link and unlink,
+// the node is in the channel's list as well
+void				User::linkChannel( Membership * m ) {
+
+	m->user_prev = _chans_tail;
+	m->user_next = NULL;
+	if (_chans_tail)
+		_chans_tail->user_next = m;
 	else
-		cout << MAGENTA << getNick() << " max number of channels reached." << RESET << endl;
-}
-
-void				User::deleteChannel( Channel * channel ) {
-
-	string chan_name;
-
-	channel->deleteOper(this);
-	channel->deleteMember(this);
-	for ( vector<Channel*>::iterator it = _channels.begin(); it != _channels.end(); it++ ) {
-		if ( (*it)->getName() == channel->getName() ) {
-			if ( this->getCurrChan() && this->getCurrChan()->getName() == channel->getName() ) {
-				if ( this->getChannels().size() > 1 ) {
-					if (this->getChannels().back()->getName() != channel->getName())
-						this->setCurrChan(this->getChannels().back());
-					else
-						this->setCurrChan(this->getChannels().front());
-				}
-				else
-					this->setCurrChan(NULL);
-			}
-			cout << MAGENTA << this->getNick() << " left channel " << channel->getName() << RESET << endl;
-			_channels.erase(it);
-			return ;
+		_chans = m;
+	_chans_tail = m;
+	_nb_chans++;
+	cout << MAGENTA << this->getNick() << " joined channel " << m->chan->getName() << RESET << endl;
+}
+
+void				User::unlinkChannel( Membership * m ) {
+
+	if ( this->getCurrChan() == m->chan ) {
+		if ( _nb_chans > 1 ) {
+			if (_chans_tail != m)
+				this->setCurrChan(_chans_tail->chan);
+			else
+				this->setCurrChan(_chans->chan);
 		}
+		else
+			this->setCurrChan(NULL);
 	}
+	if (m->user_prev)
+		m->user_prev->user_next = m->user_next;
+	else
+		_chans = m->user_next;
+	if (m->user_next)
+		m->user_next->user_prev = m->user_prev;
+	else
+		_chans_tail = m->user_prev;
+	_nb_chans--;
+	cout << MAGENTA << this->getNick() << " left channel " << m->chan->getName() << RESET << endl;
 }
 
 void				User::leaveAllChans( void ) {
 	
-	while ( !(_channels.empty()) ) {
-		
-		vector<Channel*>::iterator	chan = _channels.begin();
-		deleteChannel( *chan );
-	}
-
+	while ( _chans )
+		_chans->chan->deleteMember( this );
 }
 
 bool				User::isRegisteredToChan( Channel &c )
 {
-	for (vector<Channel*>::iterator it = _channels.begin(); it != _channels.end(); ++it )
-	{
-		if ((*it)->getName() == c.getName())
-			return true;
-	}
+	return getMembership(c) != NULL;
+}
 
-	return false;
+// Token bucket: rate tokens a second, never more than burst saved up
+void				User::refill( uint64_t now, unsigned rate, unsigned burst )
+{
+	if (now <= _refilled)
+		return ;
+
+	uint64_t	add = min((now - _refilled) * rate, (uint64_t)1 << 30);
+
+	_tokens = min((int)burst, _tokens + (int)add);
+	_refilled = now;
+}
+
+// Commands are charged after they run, the bucket may go in debt
+void				User::spend( int cost )
+{
+	_tokens -= cost;
 }
@@ -28,17 +28,12 @@
 									#Twilight_zone
 */
 
-void		invite( vector<string> args, User &usr, Server &srv ) {
+void		invite( Message const &args, User &usr, Server &srv ) {
 
 	Channel *		cnl;
 	User	*		guest;
 	
-	if ( args.size() < 2 ) {
-		send_error( usr, ERR_NEEDMOREPARAMS, "INVITE" );
-		return ;
-	}
-
-	cnl = srv.getChannelByName( args[1] );
+	cnl = srv.getChannelByName( args[1].str() );
 
 	// if channel doesnt exists
 	if ( !cnl ) {
@@ -47,24 +42,24 @@ void		invite( vector<string> args, User &usr, Server &srv ) {
 
 	// if user is not on channel
 	if ( !cnl->isOnChann(usr) )
-		return send_error( usr, ERR_NOTONCHANNEL, args[1] );
+		return send_error( usr, ERR_NOTONCHANNEL, args[1].str() );
 
 	// if user is not channel operator ans channel is invite-only
 	if ( !cnl->isOper(usr) && cnl->isInviteOnly() )
-		return send_error( usr, ERR_CHANOPRIVSNEEDED, args[1] );
+		return send_error( usr, ERR_CHANOPRIVSNEEDED, args[1].str() );
 
-	guest = srv.getUserByNick(args[0]);
+	guest = srv.getUserByNick(args[0].str());
 
 	// if guest's nick is not a valid nick
 	if ( !guest )
-		return send_error( usr, ERR_NOSUCHNICK, args[0] );
+		return send_error( usr, ERR_NOSUCHNICK, args[0].str() );
 
 	// if guest is already on channel
 	if ( cnl->isOnChann(*guest) )
-		return send_error( usr, ERR_USERONCHANNEL, args[0] + " " + args[1] );
+		return send_error( usr, ERR_USERONCHANNEL, args.join(0) );
 
-	send_notice(usr, *guest, NTC_INVITE(cnl->getName(), guest->getNick()));
-	send_reply(usr, 341, RPL_INVITING(guest->getNick(), cnl->getName()));
+	send_notice(usr, *guest, NTC_INVITE(cnl->getName(), string(guest->getNick())));
+	send_reply(usr, 341, RPL_INVITING(string(guest->getNick()), cnl->getName()));
 
 	cnl->invite(guest);
 }
\ No newline at end of file
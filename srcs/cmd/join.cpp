@@ -41,13 +41,11 @@
 
 int		create_channel( string channel, string key, User &u, Server &srv ) {
 
-	Channel	* new_channel = new Channel(channel, key, "", &u, "nt");
+	Channel	* new_channel = srv.newChannel(channel, key, &u);
 
-	srv.addChannel( new_channel );
-	u.addChannel( new_channel );
 	u.setCurrChan( new_channel );
 
-	send_reply(u, 353, RPL_NAMREPLY(new_channel->getName(), new_channel->getMembersList()));
+	send_names(u, new_channel->getName(), new_channel->getMembersList());
 	send_reply(u, 366, RPL_ENDOFNAMES(new_channel->getName()));
 	return 0;
 }
@@ -56,16 +54,14 @@ int		join_channel( string channel, string key, User &usr, Server &srv ) {
 
 	Channel 		*cnl;
 
-	if ( !usr.isRegistered() )
-	{
-		send_error( usr, ERR_NOTREGISTERED, "JOIN" );
-		return 1;
-	}		
-
 	if ( channel[0] == '#' ) {
 		cnl = srv.getChannelByName( channel );
 		if ( cnl == NULL ) // Create Channel. 
 		{
+			if ( usr.getNbChannels() >= MAX_CHAN_PER_USR ) {
+				send_error( usr, ERR_TOOMANYCHANNELS, channel );
+				return 1;
+			}
 			send_notice(usr, usr, NTC_JOIN(channel));
 			return create_channel(channel, key, usr, srv);
 		}
@@ -82,15 +78,19 @@ int		join_channel( string channel, string key, User &usr, Server &srv ) {
 	if (usr.getCurrChan())
 	{
 		// User is registred in channel and it is the current
-		if ( (usr.getCurrChan())->getName() == channel )
+		if ( usr.getCurrChan() == cnl )
 			return 0;
 		// User is registered in channel but is not the current
-		else if ( usr.isRegisteredToChan(*cnl) && (usr.getCurrChan()->getName()) != channel ) {
+		else if ( usr.isRegisteredToChan(*cnl) ) {
 			usr.setCurrChan(cnl);
 			return 0;
 		}
 	}
 
+	if ( usr.getNbChannels() >= MAX_CHAN_PER_USR ) {
+		send_error( usr, ERR_TOOMANYCHANNELS, channel );
+		return 1;
+	}
 	if ( cnl->getHasKey() && cnl->getKey() != key ) {
 		send_error( usr, ERR_BADCHANNELKEY, channel );
 		return 1;
@@ -108,35 +108,27 @@ int		join_channel( string channel, string key, User &usr, Server &srv ) {
 		return 1;
 	}
 	cnl->addMember(&usr);
-	usr.addChannel( cnl );
 	usr.setCurrChan( cnl );
-	vector<User*> usrs = cnl->getMembers();
-	for (size_t i = 0; i < usrs.size(); i++)
-		send_notice(usr, *usrs[i], NTC_JOIN(channel));
+	send_notice_channel(usr, cnl, NTC_JOIN(cnl->getName()));
 	if (cnl->getHasTopic()) {
 		send_reply(usr, 332, RPL_TOPIC(cnl->getName(), cnl->getTopic()));
-		send_reply(usr, 333, RPL_TOPICWHOTIME(cnl->getName(), cnl->getTopicWho()->fci(), cnl->getTopicWhen()));
+		send_reply(usr, 333, RPL_TOPICWHOTIME(cnl->getName(), cnl->getTopicWho(), cnl->getTopicWhen()));
 	}
-	send_reply(usr, 353, RPL_NAMREPLY(cnl->getName(), cnl->getMembersList()));
+	send_names(usr, cnl->getName(), cnl->getMembersList());
 	send_reply(usr, 366, RPL_ENDOFNAMES(cnl->getName()));
 	return 0;
 }
 
-void		join( vector<string> args, User &usr, Server &srv ) {
+void		join( Message const &args, User &usr, Server &srv ) {
 
 	vector<string>	chans;
 
-	if ( args.size() < 1 ) {
-		send_error( usr, ERR_NEEDMOREPARAMS, "JOIN" );
-		return ;
-	}
-	
-	chans = ft_split(args[0], ",");
+	chans = ft_split(args[0].str(), ",");
 
 	vector<string>	keys(chans.size());
 
 	if (args.size() > 1)
-		keys = ft_split(args[1], ",");
+		keys = ft_split(args[1].str(), ",");
 
 	for (size_t i = 0; i < chans.size(); i++) {
 		if ( i + 1 == MAX_CHAN_PER_USR ) {
@@ -37,7 +37,7 @@
 	<channel>{,<channel>} <user>{,<user>} [<comment>]
 */
 
-void		kick( vector<string> args, User &usr, Server &srv ) {
+void		kick( Message const &args, User &usr, Server &srv ) {
 
 	vector<string>	chans;
 	vector<string>	victims;
@@ -45,17 +45,11 @@ void		kick( vector<string> args, User &usr, Server &srv ) {
 	Channel *		cnl;
 	User	*		victim;
 	
-	if ( args.size() < 2 ) {
-		send_error( usr, ERR_NEEDMOREPARAMS, "KICK" );
-		return ;
-	}
-
-	chans = ft_split(args[0], ",");
-	victims = ft_split(args[1], ",");
+	chans = ft_split(args[0].str(), ",");
+	victims = ft_split(args[1].str(), ",");
 
-	reason = ":";
 	if ( args.size() > 2 )
-		reason = ft_join(args, " ", 2);
+		reason = args[2].str();
 
 	for (size_t i = 0; i < chans.size(); i++) {
 
@@ -95,12 +89,9 @@ void		kick( vector<string> args, User &usr, Server &srv ) {
 				continue ;
 			}
 
-			vector<User*> usrs = cnl->getMembers();
-			for (size_t k = 0; k < usrs.size(); k++) {
-				send_notice(usr, *usrs[k], NTC_KICK(cnl->getName(), victim->getNick(), reason));
-			}
-		
-			victim->deleteChannel(cnl);
+			send_notice_channel(usr, cnl, NTC_KICK(cnl->getName(), victim->getNick(), reason));
+
+			cnl->deleteMember(victim);
 
 			// Delete chan if usr leaving is the last usr in chan
 			if (cnl->getNbMembers() == 0)
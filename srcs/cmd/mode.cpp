@@ -103,77 +103,89 @@
 												the OPER command.
 */
 
-string		add_cnl_mode( string mode, vector<string> args, Channel *cnl, User &u, Server &srv ) {
+bool		add_cnl_mode( string mode, Message const &args, Channel *cnl, User &u, Server &srv, ModeSet &cnl_mode ) {
 
 	User *		target_usr;
-	string		arg_mode = "olvk";
-	string		cnl_mode;
-
-	cnl_mode = cnl->getMode();
+	string		arg_mode = "olvkeI";
 
 	for (size_t i = 0; i < mode.size(); i++) {
 		if ( arg_mode.find(mode[i]) != string::npos && args.size() < 3 ) {
-			send_error(u, ERR_NEEDMOREPARAMS, args[0]);
-			return "x";
+			send_error(u, ERR_NEEDMOREPARAMS, args[0].str());
+			return false;
 		}
 		if ( mode[i] == 'o' ) { 
 			// grant oper priviledge to user in arg
-			target_usr = srv.getUserByNick(args[2]);
+			target_usr = srv.getUserByNick(args[2].str());
 			if ( !target_usr ) {
-				send_error(u, ERR_NOSUCHNICK, args[2]);
-				return "x";
+				send_error(u, ERR_NOSUCHNICK, args[2].str());
+				return false;
+			}
+			if ( !cnl->isOnChann(*target_usr) ) {
+				send_error(u, ERR_NOTONCHANNEL, args[0].str());
+				return false;
 			}
 			cnl->addOper( target_usr );
 		} else if ( mode[i] == 'l' ) { 
 			// set user limit with arg
-			cnl->setLimit(atoi(args[2].c_str()));
+			cnl->setLimit(atoi(args[2].str().c_str()));
 		} else if ( mode[i] == 'b' && args.size() > 2 ) { 
 			// set ban mask
-			cnl->ban(args[2]);
+			cnl->ban(args[2].str());
+		} else if ( mode[i] == 'e' ) { 
+			// set ban exception mask
+			cnl->addExcept(args[2].str());
+		} else if ( mode[i] == 'I' ) { 
+			// set invite exception mask
+			cnl->addInvex(args[2].str());
 		} else if ( mode[i] == 'v' ) { 
 			// if chan is moderated give ability to speak to user in arg
 			if ( !cnl->isModerated() )
-				return "x";
-			target_usr = srv.getUserByNick(args[2]);
+				return false;
+			target_usr = srv.getUserByNick(args[2].str());
 			if ( !target_usr ) {
-				send_error(u, ERR_NOSUCHNICK, args[2]);
-				return "x";
+				send_error(u, ERR_NOSUCHNICK, args[2].str());
+				return false;
+			}
+			if ( !cnl->isOnChann(*target_usr) ) {
+				send_error(u, ERR_NOTONCHANNEL, args[0].str());
+				return false;
 			}
 			cnl->addModerator( target_usr );
 		} else if ( mode[i] == 'k' ) { 
 			// change key with arg
 			if ( cnl->getHasKey() ) {
-				send_error(u, ERR_KEYSET, args[2]);
-				return "x";
+				send_error(u, ERR_KEYSET, args[2].str());
+				return false;
 			}
-			cnl->setKey(args[2]);
+			cnl->setKey(args[2].str());
 		}
-		if ( cnl_mode.find(mode[i]) == string::npos)
-			cnl_mode += mode[i];
+		// Member and list modes live on the memberships and the mask lists
+		if ( string("ovbeI").find(mode[i]) == string::npos )
+			cnl_mode.add(mode[i]);
 	}
-	return cnl_mode;
+	return true;
 }
 
-string	remove_cnl_mode( string mode, vector<string> args, Channel *cnl, User &u, Server &srv ) {
+bool	remove_cnl_mode( string mode, Message const &args, Channel *cnl, User &u, Server &srv, ModeSet &cnl_mode ) {
 
 	User *		target_usr;
-	string		arg_mode = "obv";
-	string		cnl_mode;
-
-	cnl_mode = cnl->getMode();
+	string		arg_mode = "obveI";
 
 	for (size_t i = 0; i < mode.size(); i++) {
 		if ( arg_mode.find(mode[i]) != string::npos && args.size() < 3) {
-			send_error(u, ERR_NEEDMOREPARAMS, args[0]);
-			return "x";
+			send_error(u, ERR_NEEDMOREPARAMS, args[0].str());
+			return false;
 		}
-		size_t to_remove = cnl_mode.find(mode[i]);
 		if ( mode[i] == 'o' ) { 
 			// take oper priv from user in arg
-			target_usr = srv.getUserByNick(args[2]);
+			target_usr = srv.getUserByNick(args[2].str());
 			if ( !target_usr ) {
-				send_error(u, ERR_NOSUCHNICK, args[2]);
-				return "x";
+				send_error(u, ERR_NOSUCHNICK, args[2].str());
+				return false;
+			}
+			if ( !cnl->isOnChann(*target_usr) ) {
+				send_error(u, ERR_NOTONCHANNEL, args[0].str());
+				return false;
 			}
 			cnl->deleteOper( target_usr );
 		} else if ( mode[i] == 'l' ) {
@@ -181,43 +193,49 @@ string	remove_cnl_mode( string mode, vector<string> args, Channel *cnl, User &u,
 			cnl->setLimit(MAX_USR_PER_CHAN);
 		} else if ( mode[i] == 'b' ) { 
 			// delete ban mask given in arg (if on)
-			cnl->unban(args[2]);
+			cnl->unban(args[2].str());
+		} else if ( mode[i] == 'e' ) { 
+			cnl->deleteExcept(args[2].str());
+		} else if ( mode[i] == 'I' ) { 
+			cnl->deleteInvex(args[2].str());
 		} else if ( mode[i] == 'v' ) { 
 			// if chan is moderated take ability to speak from user in arg
 			if ( !cnl->isModerated() )
-				return "x";
-			target_usr = srv.getUserByNick(args[2]);
+				return false;
+			target_usr = srv.getUserByNick(args[2].str());
 			if ( !target_usr ) {
-				send_error(u, ERR_NOSUCHNICK, args[2]);
-				return "x";
+				send_error(u, ERR_NOSUCHNICK, args[2].str());
+				return false;
+			}
+			if ( !cnl->isOnChann(*target_usr) ) {
+				send_error(u, ERR_NOTONCHANNEL, args[0].str());
+				return false;
 			}
 			cnl->deleteModerator( target_usr );
 		} else if ( mode[i] == 'k' ) {
 			cnl->unsetKey();
 		}
-		if ( to_remove != string::npos ) {
-			cnl_mode.erase(cnl_mode.begin() + to_remove);
-		}
+		cnl_mode.remove(mode[i]);
 	}
-	return cnl_mode;
+	return true;
 }
 
-void		cnl_mode( vector<string> args, User &u, Server &srv ) {
+void		cnl_mode( Message const &args, User &u, Server &srv ) {
 
 	char 		flag;
 	string 		mode;
 	string		usr_mode = u.getMode();
-	Channel *	cnl = srv.getChannelByName( args[0] );
+	Channel *	cnl = srv.getChannelByName( args[0].str() );
 	string		knw_mode = AVAILABLE_CHANNEL_MODES;
 	string		arg_mode = "oblvk";
-	string		cnl_mode;
+	ModeSet		cnl_mode;
 
 	// Check channel
 	if ( !cnl )
-		return send_error(u, ERR_NOSUCHCHANNEL, args[0]);
+		return send_error(u, ERR_NOSUCHCHANNEL, args[0].str());
 
 	if ( !cnl->isOnChann(u) )
-		return send_error(u, ERR_NOTONCHANNEL, args[0]);
+		return send_error(u, ERR_NOTONCHANNEL, args[0].str());
 
 	// List channel modes
 	if ( args.size() == 1 ) {
@@ -226,55 +244,67 @@ void		cnl_mode( vector<string> args, User &u, Server &srv ) {
 		return ;
 	}
 
-	// Print ban mask list
+	// Print ban, ban exception or invite exception mask list
 	if ( args[1] == "b" || (args[1] == "+b" && args.size() < 3) ) {
-		vector<string> b_list = cnl->getBanMask();
+		vector<BanMask> const &	b_list = cnl->getBanMask();
 		for (size_t j = 0; j < b_list.size(); j++)
-			send_reply(u, 367, RPL_BANLIST(cnl->getName(), b_list[j]));
+			send_reply(u, 367, RPL_BANLIST(cnl->getName(), b_list[j].getMask()));
 		send_reply(u, 368, RPL_ENDOFBANLIST(cnl->getName()));
 		return;
 	}
+	if ( args[1] == "e" || (args[1] == "+e" && args.size() < 3) ) {
+		vector<BanMask> const &	e_list = cnl->getExceptMask();
+		for (size_t j = 0; j < e_list.size(); j++)
+			send_reply(u, 348, RPL_EXCEPTLIST(cnl->getName(), e_list[j].getMask()));
+		send_reply(u, 349, RPL_ENDOFEXCEPTLIST(cnl->getName()));
+		return;
+	}
+	if ( args[1] == "I" || (args[1] == "+I" && args.size() < 3) ) {
+		vector<BanMask> const &	i_list = cnl->getInvexMask();
+		for (size_t j = 0; j < i_list.size(); j++)
+			send_reply(u, 346, RPL_INVITELIST(cnl->getName(), i_list[j].getMask()));
+		send_reply(u, 347, RPL_ENDOFINVITELIST(cnl->getName()));
+		return;
+	}
 
 	// Parse args
 	if (args[1][0] != '+' && args[1][0] != '-') {
 		flag = ' ';
-		mode = args[1];
+		mode = args[1].str();
 	} else {
 		flag = args[1][0];
-		mode = &args[1][1];
+		mode = args[1].str().substr(1);
 	}
 
-	cnl_mode = cnl->getMode();
+	cnl_mode = cnl->getModes();
 
 	// Check user's priv: mode change (flag={+,-}) is only authorized to channel operators
 	if ( flag != ' ' && !cnl->isOper(u) )
-		return send_error(u, ERR_CHANOPRIVSNEEDED, args[0]);
+		return send_error(u, ERR_CHANOPRIVSNEEDED, args[0].str());
 	
 	// When using the 'o' and 'b' options, a restriction on a total of three per mode command has been imposed.
 	if ( flag != ' ' && (mode.find('o') || mode.find('b')) && mode.size() > 3 )
-		return send_error(u, ERR_CHANOPRIVSNEEDED, args[0]);
+		return send_error(u, ERR_CHANOPRIVSNEEDED, args[0].str());
 
 	// Check modes
-	for (size_t i = 0; i < mode.size() - 1; i++)
+	for (size_t i = 0; i < mode.size(); i++)
 		if ( knw_mode.find(mode[i]) == string::npos )
 			return send_error(u, ERR_UNKNOWNMODE, &mode[i]);
 
 	// Change mode
 	if ( flag == '+' ) {
-		cnl_mode = add_cnl_mode(mode, args, cnl, u, srv);
-		if (cnl_mode == "x")
+		if ( !add_cnl_mode(mode, args, cnl, u, srv, cnl_mode) )
 			return;
 	} else if ( flag == '-' ) {
-		cnl_mode = remove_cnl_mode(mode, args, cnl, u, srv);
-		if (cnl_mode == "x")
+		if ( !remove_cnl_mode(mode, args, cnl, u, srv, cnl_mode) )
 			return;
 	}
 	
-	cnl->setMode(cnl_mode);
+	cnl->setModes(cnl_mode);
 	if (args.size() > 2)
-		send_notice_channel(u, cnl, NTC_CHANMODE_ARG(cnl->getName(), args[1], args[2]));
+		send_notice_channel(u, cnl, NTC_CHANMODE_ARG(cnl->getName(), args[1].str(), args[2].str()));
 	else
-		send_notice_channel(u, cnl, NTC_CHANMODE(cnl->getName(), args[1]));
+		send_notice_channel(u, cnl, NTC_CHANMODE(cnl->getName(), args[1].str()));
 }
 
 static void	usr_oper(User &usr, User * target, char flag, string nick)
@@ -282,29 +312,26 @@ static void	usr_oper(User &usr, User * target, char flag, string nick)
 	if ( !target )
 		return send_error(usr, ERR_NOSUCHNICK, nick);
 	target->setIsIRCOper((flag == '+') ? true : false);
-	send_notice(usr, usr, NTC_MODE(target->getNick(), flag + "o"));
-	send_notice(usr, *target, NTC_MODE(target->getNick(), flag + "o"));
+	send_notice(usr, usr, NTC_MODE(string(target->getNick()), flag + "o"));
+	send_notice(usr, *target, NTC_MODE(string(target->getNick()), flag + "o"));
 	if (flag == '+')
 		send_reply( *target, 381, ":You are now an IRC operator\r\n");
 }
 
-void		usr_mode( vector<string> args, User &u, Server &srv ) {
+void		usr_mode( Message const &args, User &u, Server &srv ) {
 
 	string	usr_mode = u.getMode();
 	string	knw_mode = AVAILABLE_USER_MODES;
 
-	if (args.size() < 1)
-		return send_error(u, ERR_NEEDMOREPARAMS, "MODE");
-
 	if (args.size() < 2)
 		return send_reply(u, 221, RPL_UMODEIS(u.getMode()));
 
 	char flag = args[1][0];
-	string mode = args[1].substr(1, args[1].length() - 1);
+	string mode = args[1].str().substr(1);
 
-	if (u.getNick() != args[0]) {
+	if (args[0] != u.getNick()) {
 		if (u.isIRCOper() && (flag == '+' || flag == '-') && mode == "o")
-			usr_oper(u, srv.getUserByNick(args[0]), flag, args[0]);
+			usr_oper(u, srv.getUserByNick(args[0].str()), flag, args[0].str());
 		else
 			send_error(u, ERR_USERSDONTMATCH, "");
 		return ;
@@ -318,25 +345,20 @@ void		usr_mode( vector<string> args, User &u, Server &srv ) {
 	}
 
 	if (flag != '+' && flag != '-')
-		return send_error(u, ERR_UMODEUNKNOWNFLAG, args[1]);
+		return send_error(u, ERR_UMODEUNKNOWNFLAG, args[1].str());
 
 	if (flag == '+')
-		send_notice(u, u, NTC_MODE(u.getNick(), flag + u.addMode(mode)));
+		send_notice(u, u, NTC_MODE(string(u.getNick()), flag + u.addMode(mode)));
 	else if (flag == '-') 
-		send_notice(u, u, NTC_MODE(u.getNick(), flag + u.rmMode(mode)));
+		send_notice(u, u, NTC_MODE(string(u.getNick()), flag + u.rmMode(mode)));
 }
 
-void		mode( vector<string> args, User &usr, Server &srv )
+void		mode( Message const &args, User &usr, Server &srv )
 {
 	string mask = "#";
 
-	if (args.size() < 1) {
-		send_error(usr, ERR_NEEDMOREPARAMS, "MODE");
-		return ;
-	}
-
 	// find() search for full string to be match
-	if ( mask.find_first_of(args[0]) != string::npos )
+	if ( mask.find_first_of(args[0].str()) != string::npos )
 		cnl_mode(args, usr, srv);
 	else
 		usr_mode(args, usr, srv);
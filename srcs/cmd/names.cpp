@@ -42,23 +42,21 @@ void		print_other_names( User &usr, Server &srv ) {
 	
 	vector<string>		names;
 	vector<User*>		users = srv.getUsers();
-	vector<Channel*>	chans;
 	string				chan_name = "*";
-	size_t j;
+	Membership *		m;
 
 	for (vector<User*>::iterator it = users.begin(); it != users.end(); it++) {
 		if ((*it)->isVisible()) {
-			chans = (*it)->getChans();
-			for (j = 0; j < chans.size(); j++) {
-				if ( cnl_is_visible_to_usr(chans[j], usr) )
+			for (m = (*it)->getChannels(); m; m = m->user_next) {
+				if ( cnl_is_visible_to_usr(m->chan, usr) )
 					break ;
 			}
-			if (j == chans.size())
+			if (!m)
 				names.push_back( (*it)->getNick() );
 		}
 	}
 	if (names.size() > 0) {
-		send_reply(usr, 353, RPL_NAMREPLY(chan_name, ft_join(names, " ", 0)));
+		send_names(usr, chan_name, ft_join(names, " ", 0));
 		send_reply(usr, 366, RPL_ENDOFNAMES(chan_name));
 	}
 }
@@ -67,7 +65,6 @@ void		print_chan_names( string channel, User &usr, Server &srv ){
 	
 	Channel *		cnl;
 	string			reply;
-	vector<User*>	members;
 
 	cnl = srv.getChannelByName( channel );
 	if ( cnl == NULL )
@@ -75,21 +72,20 @@ void		print_chan_names( string channel, User &usr, Server &srv ){
 	if ( !cnl->isOnChann(usr) && cnl->isSecret() )
 		return ;
 	if ( cnl->isOnChann(usr) )
-		return send_reply(usr, 353, RPL_NAMREPLY(cnl->getName(), cnl->getMembersList()));
-	members = cnl->getMembers();
-	for ( size_t i = 0; i < cnl->getNbMembers(); i++ ) {
-		if ( cnl->isOper(*members[i]) && members[i]->isVisible() )
+		return send_names(usr, cnl->getName(), cnl->getMembersList());
+	for ( Membership *m = cnl->getMembers(); m; m = m->chan_next ) {
+		if ( (m->flags & MEMBER_OP) && m->user->isVisible() )
 			reply += "@";
-		if ( members[i]->isVisible() )
-			reply += members[i]->getNick();
-		if ( i < members.size() - 1 )
+		if ( m->user->isVisible() )
+			reply += m->user->getNick();
+		if ( m->chan_next )
 			reply += " ";
 	}
 	if ( trim(reply, " ") != "" )
-		send_reply(usr, 353, RPL_NAMREPLY(cnl->getName(), trim(reply, " ")));
+		send_names(usr, cnl->getName(), trim(reply, " "));
 }
 
-void		names( vector<string> args, User &usr, Server &srv ) {
+void		names( Message const &args, User &usr, Server &srv ) {
 
 	vector<string>	chans;
 	string msg = "ERROR :Not joined to any channel\r\n";
@@ -97,10 +93,10 @@ void		names( vector<string> args, User &usr, Server &srv ) {
 	if ( args.size() < 1 )
 		chans = srv.getChannelsNames();
 	else
-		chans = ft_split(args[0], ",");
+		chans = ft_split(args[0].str(), ",");
 
 	if ( args.size() < 1 ) {
-		send(usr.getFd(), &msg[0], msg.size(), 0);
+		send_msg(usr, msg);
 		return ;
 	}
 
@@ -14,59 +14,42 @@
 		ERR_UNAVAILRESOURCE             ERR_RESTRICTED
 */
 
-string		implode( vector<string>::iterator begin, vector<string>::iterator end )
+void		nick( Message const &args, User &usr, Server &srv )
 {
-	const char* const delim = " ";
+	if (args[0].empty() || args[0].size() > MAX_USR_NICK_LEN || args.size() > 1)
+	{
+		send_error(usr, ERR_ERRONEUSNICKNAME, args.join(1));
+		return ;
+	}
 
-	ostringstream str;
-	copy(begin, end, ostream_iterator<string>(str, delim));
+	string const	nick = args[0].str();
 
-	return (str.str());
-}
+	if (usr.getNick() == nick)
+		return ;
 
-void		nick( vector<string> args, User &usr, Server &srv )
-{
-	ostringstream s;
+	// Casemapped: changing the case of one's own nick is fine
+	User *	owner = srv.getUserByNick(nick);
 
-	if (args.size() == 0)
+	if (owner && owner != &usr)
 	{
-		send_error(usr, ERR_NEEDMOREPARAMS, "NICK");
+		send_error(usr, ERR_NICKNAMEINUSE, nick);
 		return ;
 	}
-	else if (args[0].empty() || args[0].length() > MAX_USR_NICK_LEN || args.size() > 1)
-	{
-		send_error(usr, ERR_ERRONEUSNICKNAME, implode(args.begin() + 1, args.end()));
-		return ;
-	}
-	if (srv.is_registered(usr) && usr.getNick() == args[0])
-		return ;
-
-	vector<User*>	usrs = srv.getUsers();
-
-	for (vector<User*>::iterator it = usrs.begin(); it != usrs.end(); it++)
-		if ((*it)->getNick() == args[0])
-		{
-			send_error(usr, ERR_NICKNAMEINUSE, args[0]);
-			return ;
-		}
 
-	if (srv.is_registered(usr))
+	if (!*usr.getNick()) 
+		cout << MAGENTA << "User #" << usr.getFd() << " nick set to " << nick << RESET << endl;
+	else	
+		cout << MAGENTA << usr.getNick() << ": Nick changed to " << nick << RESET << endl;
+	if (usr.getIsSet() && !*usr.getNick())
 	{
-		if (usr.getNick().empty()) 
-			cout << MAGENTA << "User #" << usr.getFd() << " nick set to " << args[0] << RESET << endl;
-		else	
-			cout << MAGENTA << usr.getNick() << ": Nick changed to " << args[0] << RESET << endl;
-		if (usr.getIsSet() && usr.getNick().empty())
-		{
-			if (srv.getPassword() != "")
-				if (!check_password(usr, srv))
-					return;
+		if (srv.getPassword() != "")
+			if (!check_password(usr, srv))
+				return;
 
-			cout << GREEN << "User #" << usr.getFd() << " registred as " << args[0] << RESET << endl;
-			usr.setNick(args[0]);
-			messageoftheday(srv, usr);
-		}
-		send_notice(usr, usr, NTC_NICK(args[0]));
-		usr.setNick(args[0]);
+		cout << GREEN << "User #" << usr.getFd() << " registred as " << nick << RESET << endl;
+		srv.setUserNick(usr, nick);
+		messageoftheday(srv, usr);
 	}
+	send_notice(usr, usr, NTC_NICK(nick));
+	srv.setUserNick(usr, nick);
 }
@@ -26,26 +26,21 @@
 									the password.
 */
 
-void		oper( vector<string> args, User &usr, Server &srv )
+void		oper( Message const &args, User &usr, Server &srv )
 {
-	if ( args.size() < 2 ) {
-		send_error( usr, ERR_NEEDMOREPARAMS, "OPER" );
-		return ;
-	}
-
 	if ( srv.getIRCOperators().size() == 0 ) {	
 		send_error( usr, ERR_NOOPERHOST, "OPER");
 		return ;
 	}
 
-	if ( srv.username_isIRCOper(args[0]) )
+	if ( srv.username_isIRCOper(args[0].str()) )
 	{
-		if ( !srv.isIRCOperator(args[0], args[1]) ) {
+		if ( !srv.isIRCOperator(args[0].str(), args[1].str()) ) {
 			send_error( usr, ERR_PASSWDMISMATCH, "OPER" );
 			return ;
 		}
 		usr.setIsIRCOper(true);
-		send_notice(usr, usr, NTC_MODE(usr.getNick(), "+o"));
+		send_notice(usr, usr, NTC_MODE(string(usr.getNick()), "+o"));
 		send_reply( usr, 381, ":You are now an IRC operator\r\n");
 	}
 }
\ No newline at end of file
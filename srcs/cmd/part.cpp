@@ -33,21 +33,16 @@
                                    lost".
 */
 
-void		part( vector<string> args, User &usr, Server &srv ) {
+void		part( Message const &args, User &usr, Server &srv ) {
 
 	vector<string>	chans;
 	string			part_msg;
 	Channel *		cnl;
 	
-	if ( args.size() < 1 ) {
-		send_error( usr, ERR_NEEDMOREPARAMS, "PART" );
-		return ;
-	}
-
-	chans = ft_split(args[0], ",");
+	chans = ft_split(args[0].str(), ",");
 
 	if ( args.size() > 1 )
-		part_msg = ft_join(args, " ", 1);
+		part_msg = args[1].str();
 
 	for (size_t i = 0; i < chans.size(); i++) {
 
@@ -65,18 +60,12 @@ void		part( vector<string> args, User &usr, Server &srv ) {
 			continue ;
 		}
 
-		vector<User*> usrs = cnl->getMembers();
-		for (size_t j = 0; j < usrs.size(); j++) {
-			if ( args.size() == 1 )
-				send_notice(usr, *usrs[j], NTC_PART(cnl->getName()));
-			else if (part_msg[0] == ':')
-				send_notice(usr, *usrs[j], NTC_PART_MSG(cnl->getName(), &part_msg[1]));
-			else
-				send_notice(usr, *usrs[j], NTC_PART_MSG(cnl->getName(), part_msg));
-
-		}
+		if ( args.size() == 1 )
+			send_notice_channel(usr, cnl, NTC_PART(cnl->getName()));
+		else
+			send_notice_channel(usr, cnl, NTC_PART_MSG(cnl->getName(), part_msg));
 	
-		usr.deleteChannel(cnl);
+		cnl->deleteMember(&usr);
 
 		// Delete chan if usr leaving is the last usr in chan
 		if (cnl->getNbMembers() == 0)
@@ -38,31 +38,21 @@ bool		check_password( User &usr, Server &srv )
 	s	<< "ERROR :Closing link: (" << usr.getUsername() << "@"
 		<< srv.getHost() << ") [" << error << "]\r\n";
 
-	string msg = s.str();
-
-	if ( send(usr.getFd(), &msg[0], msg.size(), 0) == -1 )
-		throw eExc(strerror(errno));
-
-	cout << BOLDWHITE << "❌ Client #" << usr.getFd() << " gone away" << RESET << endl;	
-	srv.del_from_pfds(usr.getFd());
-	srv.deleteUser( &usr );
+	send_msg(usr, s.str());
+	srv.disconnect(usr, error);
 
 	return false;
 }
 
-void		pass( vector<string> args, User &usr, Server &srv ) {
+void		pass( Message const &args, User &usr, Server &srv ) {
 
 	(void)srv;
 
-	if ( args.size() < 1 ) {
-		send_error( usr, ERR_NEEDMOREPARAMS, "PASS" );
-		return ;
-	}
 	if ( usr.isRegistered() ) {
 		send_error(usr, ERR_ALREADYREGISTRED, usr.getNick());
 		return ;
 	}
 
-	usr.setPasswd(args[0]);
+	usr.setPasswd(args[0].str());
 	cout << RED << "User #" << usr.getFd() << " password added" << RESET << endl;
 }
\ No newline at end of file
@@ -23,18 +23,13 @@
 		ERR_NOORIGIN                    ERR_NOSUCHSERVER
 */
 
-void		ping( vector<string> args, User &usr, Server &srv ) {
+void		ping( Message const &args, User &usr, Server &srv ) {
 
-	if (args.size() < 1)
+	if (args.size() > 1)
 	{
-		send_error(usr, ERR_NOORIGIN, "PING");
+		send_error(usr, ERR_NOSUCHSERVER, args[1].str());
 		return ;
 	}
-	else if (args.size() > 1)
-	{
-		send_error(usr, ERR_NOSUCHSERVER, args[1]);
-		return ;
-	}
-	string reply = ":" + srv.getHost() + " PONG " + srv.getHost() + " " + args[0] + "\r\n";
-	send(usr.getFd(), reply.c_str(), reply.length(), 0);
+	string reply = ":" + srv.getHost() + " PONG " + srv.getHost() + " :" + args[0].str() + "\r\n";
+	send_msg(usr, reply);
 }
\ No newline at end of file
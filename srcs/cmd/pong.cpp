@@ -14,16 +14,11 @@
 		ERR_NOORIGIN                    ERR_NOSUCHSERVER
 */
 
-void		pong( vector<string> args, User &usr, Server &srv ) {
+void		pong( Message const &args, User &usr, Server &srv ) {
 
-	if (args.size() == 0)
+	if (args[0] == srv.getHost())
 	{
-		send_error(usr, ERR_NOORIGIN, "PONG");
-		return ;
-	}
-	if (args[0].substr(1, args[0].size()) == srv.getHost() || args[0] == srv.getHost())
-	{
-		time(usr.getLastAct());
+		usr.setLastAct(time(0));
 		usr.setPingStatus(false);
 	}
 }
\ No newline at end of file
@@ -29,12 +29,7 @@
 
 void		send_to_all_in_chan( Channel * Chan, string txt, User &usr ) {
 	
-	vector<User*> users = Chan->getMembers();
-	for ( size_t i = 0; i < users.size(); i++ ) {
-		if (users[i]->getNick() != usr.getNick()) {
-			send_notice(usr, *users[i], NTC_PRIVMSG(Chan->getName(), txt));
-		}
-	}
+	send_notice_channel(usr, Chan, NTC_PRIVMSG(Chan->getName(), txt), &usr);
 }
 
 void		send_privmsg_to_usr( string recv, string txt, User &usr, Server &srv ) {
@@ -44,7 +39,7 @@ void		send_privmsg_to_usr( string recv, string txt, User &usr, Server &srv ) {
 	receiver = srv.getUserByNick(recv);
 	if ( !receiver )
 		return send_error(usr, ERR_NOSUCHNICK, recv);
-	send_notice(usr, *receiver, NTC_PRIVMSG(receiver->getNick(), txt));
+	send_notice(usr, *receiver, NTC_PRIVMSG(string(receiver->getNick()), txt));
 }
 
 void		send_privmsg_to_chan( string recv, string txt, User &usr, Server &srv ) {
@@ -59,6 +54,8 @@ void		send_privmsg_to_chan( string recv, string txt, User &usr, Server &srv ) {
 		return send_error(usr, ERR_CANNOTSENDTOCHAN, recv);
 	if ( channel->isModerated() && !channel->isModerator(usr) )
 		return send_error(usr, ERR_CANNOTSENDTOCHAN, recv);
+	if ( channel->isBanned(usr) && !channel->isModerator(usr) && !channel->isOper(usr) )
+		return send_error(usr, ERR_CANNOTSENDTOCHAN, recv);
 	send_to_all_in_chan( channel, txt, usr );
 }
 
@@ -77,18 +74,16 @@ void		send_privmsg( string recv, string txt, User &usr, Server &srv ) {
 	return;
 }
 
-void		privmsg( vector<string> args, User &usr, Server &srv ) {
+void		privmsg( Message const &args, User &usr, Server &srv ) {
 
-	if (args.size() < 1)
-		return send_error(usr, ERR_NORECIPIENT, "");
 	if (args.size() < 2)
 		return send_error(usr, ERR_NOTEXTTOSEND, "");
 
-	vector<string> recvs = ft_split(args[0], ",");
+	vector<string> recvs = ft_split(args[0].str(), ",");
 
 	if (has_duplicates(recvs))
 		return send_error(usr, ERR_TOOMANYTARGETS, find_duplicates(recvs));
 
 	for (vector<string>::iterator it = recvs.begin(); it != recvs.end(); it++)
-		send_privmsg(*it, ft_join(args, " ", 1), usr, srv);
+		send_privmsg(*it, args[1].str(), usr, srv);
 }
\ No newline at end of file
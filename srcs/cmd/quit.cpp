@@ -49,35 +49,12 @@
 	QUIT :Gone to have lunch        ; Preferred message format
 */
 
-void		quit( vector<string> args, User &usr, Server &srv )
+void		quit( Message const &args, User &usr, Server &srv )
 {
 	string	msg;
 
 	if (args.size() > 0)
-		args[0] = &args[0][1];
+		msg = args[0].str();
 
-	msg = ft_join(args, " ", 0);
-
-	vector<Channel *>	usr_channels = usr.getChannels();
-
-	if (usr_channels.size())
-		for (vector<Channel*>::iterator it = usr_channels.begin(); it != usr_channels.end(); it++)
-			send_notice_channel(usr, *it, NTC_QUIT(msg));
-
-	usr.leaveAllChans();
-
-	vector<Channel *>	srv_channels = srv.getChannels();
-
-	if (srv_channels.size())
-		for (vector<Channel*>::iterator it = srv_channels.begin(); it != srv_channels.end(); it++)
-			if ( !(*it)->getNbMembers() )
-				srv.deleteChannel(*it);
-
-	int fd = usr.getFd();
-
-	
-	srv.del_from_pfds(fd);
-	srv.deleteUser( &usr );
-	
-	cout << BOLDWHITE << "❌ Client #" << fd << " gone away" << RESET << endl;
+	srv.disconnect(usr, msg);
 }
\ No newline at end of file
@@ -32,27 +32,22 @@
                                    			#test.
 */
 
-void		topic( vector<string> args, User &usr, Server &srv ) {
+void		topic( Message const &args, User &usr, Server &srv ) {
 
 	Channel *		cnl;
 	string			topic = "";
 
-	if ( args.size() < 1 )
-		return send_error( usr, ERR_NEEDMOREPARAMS, "TOPIC" );
-
-	cnl = srv.getChannelByName( args[0] );
+	cnl = srv.getChannelByName( args[0].str() );
 	if ( cnl == NULL || !cnl->isOnChann(usr) )
-		return send_error( usr, ERR_NOTONCHANNEL, args[0] );
+		return send_error( usr, ERR_NOTONCHANNEL, args[0].str() );
 	
 	if ( args.size() > 1 ) {
 		if ( cnl->isTopicSettableByOperOnly() && !cnl->isOper(usr) )
-			return send_error( usr, ERR_CHANOPRIVSNEEDED, args[0] );
-		if ( args[1] == ":" ) {
+			return send_error( usr, ERR_CHANOPRIVSNEEDED, args[0].str() );
+		if ( args[1].empty() ) {
 			cnl->unsetTopic( &usr );
 		} else {
-			topic = ft_join( args, " ", 1);
-			if ( topic[0] == ':' )
-				topic = &topic[1];
+			topic = args[1].str();
 			cnl->setTopic( topic, &usr );
 		}
 		return send_notice_channel(usr, cnl, NTC_TOPIC(cnl->getName(), topic));
@@ -16,26 +16,21 @@
         ERR_NEEDMOREPARAMS              ERR_ALREADYREGISTRED
 */
 
-void	user( vector<string> args, User &usr, Server &srv )
+void	user( Message const &args, User &usr, Server &srv )
 {
-	if (args.size() < 4)
-	{
-		send_error(usr, ERR_NEEDMOREPARAMS, "USER");
-		return ;
-	}
 	if (usr.getIsSet())
 	{
 		send_error(usr, ERR_ALREADYREGISTRED, usr.getNick());
 		return ;
 	}
 
-	usr.setUsername(args[0]);
-	usr.setHostname(args[1]);
-	usr.setServername(args[2]);
-	usr.setRealName(ft_join(args, " ", 3));
+	usr.setUsername(args[0].str());
+	usr.setHostname(args[1].str());
+	usr.setServername(args[2].str());
+	usr.setRealName(args[3].str());
 	usr.setIsSet(true);
 
-	if (!usr.getNick().empty())
+	if (*usr.getNick())
 	{
 		if (srv.getPassword() != "")
 			if (!check_password(usr, srv))
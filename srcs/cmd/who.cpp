@@ -49,7 +49,7 @@
 		   of the form: :servername 315 user #c1,#c2 :End of /WHO list.
 */
 
-static int		who_user( const vector<string> args, User &usr, Server &srv, bool wild )
+static int		who_user( string const &name, Message const &args, User &usr, Server &srv, bool wild )
 {
 	ostringstream	s;
 
@@ -64,8 +64,8 @@ static int		who_user( const vector<string> args, User &usr, Server &srv, bool wi
 
 			// irssi syntax :<server> 352 <user> <*|u.curr_channel> <u.realname> <u.hostname> <u.servername>
 			//									 <u.nickname> <H|G>[*][@|+] :<hopcount> <u.realname>
-			if ( (u->getNick() == args[0] || u->getHostname() == args[0] || u->getServername() == args[0]
-				|| u->getRealName() == args[0] ))
+			if ( (u->getNick() == name || u->getHostname() == name || u->getServername() == name
+				|| u->getRealName() == name ))
 			{
 				send_reply(usr, 352, RPL_WHOREPLY((u->getCurrChan() ? u->getCurrChan()->getName() : "*"),
 					u->getUsername(), u->getHostname(), u->getServername(), u->getNick(),
@@ -78,79 +78,52 @@ static int		who_user( const vector<string> args, User &usr, Server &srv, bool wi
 	if (wild == true)
 		send_reply(usr, 315, RPL_ENDOFWHO(string("*")));
 	else
-		send_reply(usr, 315, RPL_ENDOFWHO(args[0]));	
+		send_reply(usr, 315, RPL_ENDOFWHO(name));	
 	
 	return 1;
 }
 
-int				who_channel( const vector<string> args, User &usr, Server &srv, bool wild ) {
+int				who_channel( string const &name, Message const &args, User &usr, Server &srv, bool wild ) {
 	
 	ostringstream	s;
 
-	vector<Channel*>	chans = srv.getChannels();
-	Channel				*c = NULL;
-
-	for (vector<Channel*>::iterator it = chans.begin(); it != chans.end(); it++)
-		if ((*it)->getName() == args[0])
-		{
-			c = *it;
-			break;
-		}
+	Channel *		c = srv.getChannelByName(name);
 
 	// Works only if is only <channel> or <channel> + <channel2> (<channel2> is ignored)
 	if ( (args.size() == 1 || (args.size() == 2 && args[1][0] == '#')) && c
 		&& usr.isRegisteredToChan(*c) )
 	{
-		vector<User*>	users = c->getMembers();
-
-		for ( vector<User*>::iterator it = users.begin(); it != users.end(); ++it )
+		for ( Membership *m = c->getMembers(); m; m = m->chan_next )
 		{
-			User u = *(*it);
+			User & u = *m->user;
 			send_reply(usr, 352, RPL_WHOREPLY((u.getCurrChan() ? u.getCurrChan()->getName() : "*"),
 				u.getUsername(), u.getHostname(), u.getServername(), u.getNick(),
 				(u.isIRCOper() ? "*" : ""), (u.isChanOper() ? "@" : ""), u.getRealName()));
 		}
 	}
 
-	send_reply(usr, 315, RPL_ENDOFWHO(wild == true ? "*" : args[0]));
+	send_reply(usr, 315, RPL_ENDOFWHO(wild == true ? "*" : name));
 	return 1;
 }
 
-int				who_wildcard( vector<string> args, User &usr, Server &srv)
+int				who_wildcard( Message const &args, User &usr, Server &srv)
 {
 	Channel		*chan = usr.getCurrChan();
 
 	if (chan != NULL)
-	{
-		args[0] = chan->getName();
-		who_channel(args, usr, srv, true);
-	}
+		who_channel(chan->getName(), args, usr, srv, true);
 	else
-	{
-		args[0] = usr.getNick();
-		who_user(args, usr, srv, true);
-	}
+		who_user(usr.getNick(), args, usr, srv, true);
 
 	return 1;
 }
 
-void			who( vector<string> args, User &usr, Server &srv ) {
-
-	if (args.size() == 0)
-	{
-		send_error(usr, ERR_NEEDMOREPARAMS, "WHO");
-		return ;
-	}
-	if ( !usr.isRegistered() )
-	{
-		send_error( usr, ERR_NOTREGISTERED, "WHO" );
-		return ;
-	}
+void			who( Message const &args, User &usr, Server &srv ) {
 
 	if (args[0][0] == '#')
-		who_channel(args, usr, srv, false);
+		who_channel(args[0].str(), args, usr, srv, false);
 	else if (args[0] == "*")
 		who_wildcard(args, usr, srv);
 	else
-		who_user(args, usr, srv, false);
+		who_user(args[0].str(), args, usr, srv, false);
 }
@@ -5,10 +5,21 @@ static bool				valid_param( string name, string value )
 	char	buf[BUFSIZE];
 
 	if ((name == "PORT" && !is_digit(value)) || (name == "NAME" && !is_alpha(value))
-		|| (name == "HOST" && !inet_pton(AF_INET, value.c_str(), buf)))
+		|| (name == "HOST" && !inet_pton(AF_INET, value.c_str(), buf))
+		|| (name == "MAXCLI" && (!is_digit(value) || value.empty()))
+		|| (name == "SENDQ" && (!is_digit(value) || value.empty()))
+		|| ((name == "PING_FREQ" || name == "PING_TIMEOUT" || name == "REG_TIMEOUT"
+			|| name == "FLOOD_BURST" || name == "FLOOD_RATE")
+			&& (!is_digit(value) || value.empty()))
+		|| (name == "SHARDS" && (!is_digit(value) || value.empty() || atoi(value.c_str()) > 64))
+		|| (name == "POLLER" && value != "poll" && value != "epoll" && value != "io_uring"))
 		return  false;
 	if (name == "PORT" || name == "NAME" || name == "SRV_PWD" ||
-		name == "MOTD" || name == "OPER" || name == "HOST")
+		name == "MOTD" || name == "OPER" || name == "HOST" ||
+		name == "POLLER" || name == "MAXCLI" || name == "SHARDS" ||
+		name == "SENDQ" || name == "PING_FREQ" || name == "PING_TIMEOUT" ||
+		name == "REG_TIMEOUT" || name == "FLOOD_BURST" || name == "FLOOD_RATE" ||
+		name == "FLOOD_COST")
 		return true;
 	
 	return false;
@@ -6,11 +6,33 @@ int display_usage( void ) {
     return 1;
 }
 
-//	Errors list
-map<int, string>	err;
+//	Errors list, indexed by numeric
+string				err[NUMERIC_MAX];
+
+//	":mfirc 001 " to ":mfirc 999 ", formatted once at startup
+static char			numeric_prefix[NUMERIC_MAX][NUMERIC_PREFIX_LEN];
+
+static void			define_numerics( void )
+{
+	size_t	srv_len = sizeof(SERVER_NAME) - 1;
+
+	for (int n = 0; n < NUMERIC_MAX; n++) {
+		char *	p = numeric_prefix[n];
+
+		*p++ = ':';
+		memcpy(p, SERVER_NAME, srv_len);
+		p += srv_len;
+		*p++ = ' ';
+		*p++ = '0' + n / 100;
+		*p++ = '0' + n / 10 % 10;
+		*p++ = '0' + n % 10;
+		*p++ = ' ';
+	}
+}
 
 void    define_errors( void )
 {
+	define_numerics();
 	err[ERR_NOSUCHNICK] = " :No such nick";
 	err[ERR_NOSUCHSERVER] = " :No such server";
 	err[ERR_NOSUCHCHANNEL] = " :No such channel";
@@ -43,49 +65,113 @@ void    define_errors( void )
 	err[ERR_PASSWDMISMATCH] = " :Password incorrect";
 }
 
-void    send_error( User u, int errn, string arg )
+// Queues a raw line, its owning shard writes it once the command is done
+void	send_msg( User &u, string const &msg )
 {
-	ostringstream s;
-
-	if (*(arg.end() - 1) == '\n')
-		arg = arg.substr(0, arg.length()-1);
-	s << ":mfirc " << errn << " * " << arg << err[errn] << "\r\n";
-
-	string msg = s.str();
-
-	if ( send(u.getFd(), &msg[0], msg.size(), 0) == -1 )
-		throw eExc(strerror(errno));
+	u.getSendQ().push(msg);
+	if (u.getShard())
+		u.getShard()->wantFlush(u);
 }
 
-void    send_reply( User u, int rpln, string reply )
+void	send_msg( User &u, SharedBuf const &msg )
 {
-	ostringstream s;
-
-	s	<< ":mfirc "
-		<< setfill('0') << setw(3) << rpln
-		<< " " << u.getNick() << " " << reply;
-	string msg = s.str();
-
-	if ( send(u.getFd(), &msg[0], msg.size(), 0) == -1 )
-		throw eExc(strerror(errno));
+	u.getSendQ().push(msg);
+	if (u.getShard())
+		u.getShard()->wantFlush(u);
 }
 
-void		send_notice_channel(User &u, Channel *c, string notice)
+// Both build the line straight into the tail of the recipient's SendQ
+void    send_error( User &u, int errn, string const &arg )
 {
-	vector<User*>	members = c->getMembers();
-
-	for (vector<User*>::iterator it = members.begin(); it != members.end(); it++)
-		send_notice(u, *(*it), notice);
+	size_t			arg_len = arg.size();
+
+	if (arg_len && arg[arg_len - 1] == '\n')
+		arg_len--;
+
+	string const &	txt = err[errn];
+	size_t			len = NUMERIC_PREFIX_LEN + 2 + arg_len + txt.size() + 2;
+	char *			p = u.getSendQ().reserve(len);
+
+	if (p) {
+		memcpy(p, numeric_prefix[errn], NUMERIC_PREFIX_LEN);
+		p += NUMERIC_PREFIX_LEN;
+		memcpy(p, "* ", 2);
+		memcpy(p + 2, arg.data(), arg_len);
+		p += 2 + arg_len;
+		memcpy(p, txt.data(), txt.size());
+		memcpy(p + txt.size(), "\r\n", 2);
+		u.getSendQ().commit(len);
+	}
+	if (u.getShard())
+		u.getShard()->wantFlush(u);
 }
 
-void	send_notice( User from, User to, string notice )
+void    send_reply( User &u, int rpln, string const &reply )
 {
-	ostringstream s;
+	char const *	nick = u.getNick();
+	size_t			nick_len = strlen(nick);
+	size_t			len = NUMERIC_PREFIX_LEN + nick_len + 1 + reply.size();
+	char *			p = u.getSendQ().reserve(len);
+
+	if (p) {
+		memcpy(p, numeric_prefix[rpln], NUMERIC_PREFIX_LEN);
+		p += NUMERIC_PREFIX_LEN;
+		memcpy(p, nick, nick_len);
+		p += nick_len;
+		*p++ = ' ';
+		memcpy(p, reply.data(), reply.size());
+		u.getSendQ().commit(len);
+	}
+	if (u.getShard())
+		u.getShard()->wantFlush(u);
+}
 
-	s << ":" << from.fci() << " " << notice << "\r\n";
+// A big channel doesn't fit in one 353, the list is cut between two nicks
+void	send_names( User &u, string const &chan, string const &list )
+{
+	size_t	room = MSG_MAXLEN - NUMERIC_PREFIX_LEN - strlen(u.getNick()) - chan.size() - 7;
+	size_t	start = 0;
+
+	while (list.size() - start > room) {
+		size_t	cut = list.rfind(' ', start + room);
+
+		if (cut == string::npos || cut <= start)
+			break ;
+		send_reply(u, 353, RPL_NAMREPLY(chan, list.substr(start, cut - start)));
+		start = cut + 1;
+	}
+	send_reply(u, 353, RPL_NAMREPLY(chan, list.substr(start)));
+}
 
-	string msg = s.str();
+// The line is formatted once, every member's queue gets a reference to it
+void		send_notice_channel(User &u, Channel *c, string const &notice, User *except)
+{
+	string const &	prefix = u.getPrefix();
+	SharedBuf		line(prefix.size() + notice.size() + 2);
+	char *			p = line.tail();
+
+	memcpy(p, prefix.data(), prefix.size());
+	memcpy(p + prefix.size(), notice.data(), notice.size());
+	memcpy(p + prefix.size() + notice.size(), "\r\n", 2);
+	line.grow(prefix.size() + notice.size() + 2);
+
+	for (Membership *m = c->getMembers(); m; m = m->chan_next)
+		if (m->user != except)
+			send_msg(*m->user, line);
+}
 
-	if ( send(to.getFd(), &msg[0], msg.size(), 0) == -1 )
-		throw eExc(strerror(errno));
-}
\ No newline at end of file
+void	send_notice( User &from, User &to, string const &notice )
+{
+	string const &	prefix = from.getPrefix();
+	size_t			len = prefix.size() + notice.size() + 2;
+	char *			p = to.getSendQ().reserve(len);
+
+	if (p) {
+		memcpy(p, prefix.data(), prefix.size());
+		memcpy(p + prefix.size(), notice.data(), notice.size());
+		memcpy(p + prefix.size() + notice.size(), "\r\n", 2);
+		to.getSendQ().commit(len);
+	}
+	if (to.getShard())
+		to.getShard()->wantFlush(to);
+}
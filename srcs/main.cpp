@@ -5,12 +5,15 @@ int main( int argc, char *argv[] ) {
 	map<string, string> p;
 
 	define_errors();
+	// A peer closing mid-write must give EPIPE, not kill the server
+	signal(SIGPIPE, SIG_IGN);
 
 	try {
 		p = parser( argc, argv );
 		// Had to copy initConn() and run() two times because of the scope
 		if ( p.size() > 2 ) {
 			Server ircserv(p["PORT"], p["SRV_PWD"], p["HOST"], p["MOTD"], p["OPER"]);
+			ircserv.setOptions(p);
 			ircserv.initConn();
 			ircserv.run();
 		}
@@ -18,43 +18,93 @@ map<string, string>		parser( int n_params, char *params[] ) {
 	return res;
 }
 
-int						parsing( vector<string> args, User &usr, Server &srv )
+// Sorted by name for find_command(), costs may be changed by the conf
+static Command			g_commands[] = {
+	//	name		handler		params	error if fewer			registered	cost
+	{	"INVITE",	invite,		2,		ERR_NEEDMOREPARAMS,		true,		1	},
+	{	"JOIN",		join,		1,		ERR_NEEDMOREPARAMS,		true,		2	},
+	{	"KICK",		kick,		2,		ERR_NEEDMOREPARAMS,		true,		1	},
+	{	"MODE",		mode,		1,		ERR_NEEDMOREPARAMS,		true,		1	},
+	{	"NAMES",	names,		0,		0,						true,		3	},
+	{	"NICK",		nick,		1,		ERR_NEEDMOREPARAMS,		false,		2	},
+	{	"NOTICE",	notice,		1,		ERR_NORECIPIENT,		true,		1	},
+	{	"OPER",		oper,		2,		ERR_NEEDMOREPARAMS,		true,		2	},
+	{	"PART",		part,		1,		ERR_NEEDMOREPARAMS,		true,		1	},
+	{	"PASS",		pass,		1,		ERR_NEEDMOREPARAMS,		false,		2	},
+	{	"PING",		ping,		1,		ERR_NOORIGIN,			false,		1	},
+	{	"PONG",		pong,		1,		ERR_NOORIGIN,			false,		1	},
+	{	"PRIVMSG",	privmsg,	1,		ERR_NORECIPIENT,		true,		1	},
+	{	"QUIT",		quit,		0,		0,						false,		1	},
+	{	"TOPIC",	topic,		1,		ERR_NEEDMOREPARAMS,		true,		1	},
+	{	"USER",		user,		4,		ERR_NEEDMOREPARAMS,		false,		1	},
+	{	"WHO",		who,		1,		ERR_NEEDMOREPARAMS,		true,		3	},
+};
+
+// Case insensitive, name is upper case
+static int				cmp_command( StrView const & v, char const * name )
 {
-	string	cmd = args[0];
-
-	transform(cmd.begin(), cmd.end(), cmd.begin(), ::toupper);
-	
-	for (size_t i = 0; i < args.size(); i++) 
-		if (back(args[i]) == '\r')
-			args[i] = pop_back(args[i]);
-
-	map<string, FnPtr>	m;
-
-	m["NICK"] = nick;
-	m["USER"] = user;
-	m["MODE"] = mode;
-	m["PING"] = ping;
-	m["PONG"] = pong;
-	m["JOIN"] = join;
-	m["MODE"] = mode;
-	m["WHO"] = who;
-	m["PRIVMSG"] = privmsg;
-	m["PART"] = part;
-	m["PASS"] = pass;
-	m["TOPIC"] = topic;
-	m["NAMES"] = names;
-	m["QUIT"] = quit;
-	m["KICK"] = kick;
-	m["NOTICE"] = notice;
-	m["INVITE"] = invite;
-	m["OPER"] = oper;
-
-	// Call function
-	if ( m.count(cmd) > 0 ) {
-		args.erase(args.begin());	// Remove args[0] (command)
-		m[cmd](args, usr, srv);
-		return 1;
+	size_t	i = 0;
+
+	for (; i < v.len && name[i]; i++)
+		if (int d = toupper((unsigned char)v.ptr[i]) - name[i])
+			return d;
+	return (i < v.len) - (name[i] != '\0');
+}
+
+Command const *			find_command( StrView const & name )
+{
+	size_t	lo = 0;
+	size_t	hi = sizeof g_commands / sizeof *g_commands;
+
+	while (lo < hi) {
+		size_t	mid = (lo + hi) / 2;
+		int		d = cmp_command(name, g_commands[mid].name);
+
+		if (!d)
+			return &g_commands[mid];
+		if (d < 0)
+			hi = mid;
+		else
+			lo = mid + 1;
 	}
+	return NULL;
+}
+
+// "WHO:5|NAMES:5" overrides the default costs, false on a bad entry
+bool					set_command_costs( string const & list )
+{
+	vector<string>		entries = ft_split(list, "|");
+
+	for (vector<string>::iterator it = entries.begin(); it != entries.end(); ++it) {
+		vector<string>	tmp = ft_split(*it, ":");
 
-	return 0;
-}
\ No newline at end of file
+		if (tmp.size() != 2 || tmp[1].empty() || !is_digit(tmp[1]))
+			return false;
+
+		Command const *	cmd = find_command(StrView(tmp[0].data(), tmp[0].size()));
+
+		if (!cmd)
+			return false;
+		g_commands[cmd - g_commands].cost = atoi(tmp[1].c_str());
+	}
+	return true;
+}
+
+// Checks what the table knows about the command, then runs its handler.
+// Returns what the line costs to the sender's flood control.
+int						parsing( Message const & msg, User &usr, Server &srv )
+{
+	Command const *		cmd = find_command(msg.getCommand());
+
+	if ( !cmd )
+		return 1;
+
+	if ( cmd->registered && !usr.isRegistered() )
+		send_error(usr, ERR_NOTREGISTERED, cmd->name);
+	else if ( msg.size() < cmd->min_params )
+		send_error(usr, cmd->err, cmd->name);
+	else
+		cmd->fn(msg, usr, srv);
+
+	return cmd->cost;
+}
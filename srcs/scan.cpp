@@ -0,0 +1,149 @@
+#include "headers.hpp"
+
+/*								SCALAR										*/
+
+static size_t		eol_scalar( char const * p, size_t n )
+{
+	for (size_t i = 0; i < n; i++)
+		if (p[i] == '\n' || p[i] == '\r')
+			return i;
+	return n;
+}
+
+static size_t		delims_scalar( char const * p, size_t n, unsigned short * offs )
+{
+	size_t	k = 0;
+
+	for (size_t i = 0; i < n; i++)
+		if (p[i] == ' ' || p[i] == ':')
+			offs[k++] = i;
+	return k;
+}
+
+# ifdef HAS_X86_SIMD
+
+/*								SSE2										*/
+
+static size_t		eol_sse2( char const * p, size_t n )
+{
+	__m128i const	cr = _mm_set1_epi8('\r');
+	__m128i const	lf = _mm_set1_epi8('\n');
+	size_t			i = 0;
+
+	for (; i + 16 <= n; i += 16) {
+		__m128i		v = _mm_loadu_si128(reinterpret_cast<__m128i const *>(p + i));
+		int			m = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, cr), _mm_cmpeq_epi8(v, lf)));
+
+		if (m)
+			return i + __builtin_ctz(m);
+	}
+	return i + eol_scalar(p + i, n - i);
+}
+
+static size_t		delims_sse2( char const * p, size_t n, unsigned short * offs )
+{
+	__m128i const	sp = _mm_set1_epi8(' ');
+	__m128i const	col = _mm_set1_epi8(':');
+	size_t			i = 0;
+	size_t			k = 0;
+
+	for (; i + 16 <= n; i += 16) {
+		__m128i		v = _mm_loadu_si128(reinterpret_cast<__m128i const *>(p + i));
+		unsigned	m = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, sp), _mm_cmpeq_epi8(v, col)));
+
+		for (; m; m &= m - 1)
+			offs[k++] = i + __builtin_ctz(m);
+	}
+	for (size_t j = k + delims_scalar(p + i, n - i, offs + k); k < j; k++)
+		offs[k] += i;
+	return k;
+}
+
+/*								AVX2										*/
+
+__attribute__((target("avx2")))
+static size_t		eol_avx2( char const * p, size_t n )
+{
+	__m256i const	cr = _mm256_set1_epi8('\r');
+	__m256i const	lf = _mm256_set1_epi8('\n');
+	size_t			i = 0;
+
+	for (; i + 32 <= n; i += 32) {
+		__m256i		v = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(p + i));
+		unsigned	m = _mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(v, cr), _mm256_cmpeq_epi8(v, lf)));
+
+		if (m)
+			return i + __builtin_ctz(m);
+	}
+	return i + eol_sse2(p + i, n - i);
+}
+
+__attribute__((target("avx2")))
+static size_t		delims_avx2( char const * p, size_t n, unsigned short * offs )
+{
+	__m256i const	sp = _mm256_set1_epi8(' ');
+	__m256i const	col = _mm256_set1_epi8(':');
+	size_t			i = 0;
+	size_t			k = 0;
+
+	for (; i + 32 <= n; i += 32) {
+		__m256i		v = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(p + i));
+		unsigned	m = _mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(v, sp), _mm256_cmpeq_epi8(v, col)));
+
+		for (; m; m &= m - 1)
+			offs[k++] = i + __builtin_ctz(m);
+	}
+	for (size_t j = k + delims_sse2(p + i, n - i, offs + k); k < j; k++)
+		offs[k] += i;
+	return k;
+}
+
+# endif
+
+/*								DISPATCH									*/
+
+struct ScanImpl
+{
+	char const *	name;
+	size_t			(*eol)( char const *, size_t );
+	size_t			(*delims)( char const *, size_t, unsigned short * );
+};
+
+static ScanImpl		pick_impl( void )
+{
+	ScanImpl	impl = { "scalar", eol_scalar, delims_scalar };
+
+# ifdef HAS_X86_SIMD
+	impl.name = "sse2";
+	impl.eol = eol_sse2;
+	impl.delims = delims_sse2;
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2")) {
+		impl.name = "avx2";
+		impl.eol = eol_avx2;
+		impl.delims = delims_avx2;
+	}
+# endif
+	return impl;
+}
+
+// Resolved before main(), so the shards never race on it
+static ScanImpl const	g_scan = pick_impl();
+
+// Offset of the first CR or LF in [p, p + n), n if there is none
+size_t				scan_eol( char const * p, size_t n )
+{
+	return g_scan.eol(p, n);
+}
+
+// Offsets of every space and ':' in [p, p + n), in order, n < 65536.
+// offs must hold n entries. Returns how many were found.
+size_t				scan_delims( char const * p, size_t n, unsigned short * offs )
+{
+	return g_scan.delims(p, n, offs);
+}
+
+char const *		scan_name( void )
+{
+	return g_scan.name;
+}
@@ -27,6 +27,15 @@ string				to_upper( string s )
 	return (s);
 }
 
+// Unaffected by wall clock changes, for timeouts
+uint64_t			monotonic_ms( void )
+{
+	struct timespec	ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
 bool		is_digit( string s )
 {
 	for (string::iterator it = s.begin(); it != s.end(); it++)
@@ -105,37 +114,6 @@ string ft_join(vector<string> str, string sep, int begin) {
 	return res;
 }
 
-bool ft_match( string const &str, string const &pattern ) {
-
-	int n = str.size();
-	int m = pattern.size();
-
-	if (m == 0)
-        return (n == 0);
- 
-    bool lookup[n + 1][m + 1];
-    memset(lookup, false, sizeof(lookup));
- 
-    lookup[0][0] = true;
- 
-    for (int j = 1; j <= m; j++)
-        if (pattern[j - 1] == '*')
-            lookup[0][j] = lookup[0][j - 1];
- 
-    for (int i = 1; i <= n; i++) {
-        for (int j = 1; j <= m; j++) {
-            if (pattern[j - 1] == '*')
-                lookup[i][j] = lookup[i][j - 1] || lookup[i - 1][j];
-            else if (pattern[j - 1] == '?' || str[i - 1] == pattern[j - 1])
-                lookup[i][j] = lookup[i - 1][j - 1];
-            else
-                lookup[i][j] = false;
-        }
-    }
- 
-    return lookup[n][m];
-}
-
 void get_infos(const string &str, string &nickname, string &username, string &hostname) {
 	
 	(void)str;
@@ -177,9 +155,9 @@ string			get_time()
 	return (ctime(&now));
 }
 
-void    		messageoftheday( Server &srv, User usr )
+void    		messageoftheday( Server &srv, User &usr )
 {
-	send_reply(usr, 001, RPL_WELCOME(usr.getNick(), usr.getUsername(), usr.getHostname()));
+	send_reply(usr, 001, RPL_WELCOME(string(usr.getNick()), usr.getUsername(), usr.getHostname()));
 	send_reply(usr, 002, RPL_YOURHOST(srv.getName(), SERVER_VERSION));
 	send_reply(usr, 003, RPL_CREATED(srv.getCreationDate()));
 	send_reply(usr, 004, RPL_MYINFO(srv.getName(), SERVER_VERSION, AVAILABLE_USER_MODES, AVAILABLE_CHANNEL_MODES));